@@ -172,13 +172,16 @@ const struct defaultEEPromData {
 /**
  *  \brief    Set EEPROM memory contents to factory default values.
  *  \remarks  A device with default adress must not be on the bus.
- *            \n<tt>Only user allowed memory locations are written.</tt>
+ *            \n<tt>Only user allowed memory locations are written, and only if they differ.</tt>
  */
 void setEEPromDefaults(void) {
-
-    for(uint8_t i = 0; i < sizeof(eDat)/sizeof(defaultEEPromData),
-        !mlx.rwError; i++) { 
-        mlx.writeEEProm(eDat[i].address, eDat[i].data);
-    }
+    uint16_t image[MLX90614_EEWORDS];
+    MLX90614::imageReport_t report;
+
+    if(mlx.readImage(image)) return;
+    for(uint8_t i = 0; i < sizeof(eDat)/sizeof(defaultEEPromData); i++)
+        image[eDat[i].address & 0x1f] = eDat[i].data;
+    mlx.writeImage(image, report);
+    printf("EEProm words written %08lXh failed %08lXh\n", report.written, report.failed);
 }
 
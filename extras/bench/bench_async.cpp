@@ -0,0 +1,100 @@
+/***********************************************************************************************//**
+ *  \brief      MLX90614 host benchmark - asynchronous read versus readTemp().
+ *  \par
+ *  \par        Details
+ *              A simulated control loop does a fixed 10us slice of work per iteration and reads
+ *              object temperature continuously, either blocking with readTemp() or with
+ *              startRead()/poll(). Both run for one second of simulated time; the number of work
+ *              slices completed shows how much loop time the asynchronous read frees. The
+ *              results of both paths are also checked to be bit identical.
+ *  \par        Build
+ *              See extras/README.md.
+ *
+ *  \file       BENCH_ASYNC.CPP
+ *  \author     J. F. Fitter <jfitter@eagleairaust.com.au>
+ *  \version    1.0
+ *  \date       2014-2017
+ *  \copyright  Copyright &copy; 2017 John Fitter.  All right reserved.
+ *
+ *  \par        License
+ *              This program is free software; you can redistribute it and/or modify it under
+ *              the terms of the GNU Lesser General Public License as published by the Free
+ *              Software Foundation; either version 2.1 of the License, or (at your option)
+ *              any later version.
+ *  \par
+ *              This Program is distributed in the hope that it will be useful, but WITHOUT ANY
+ *              WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *              PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details
+ *              at http://www.gnu.org/copyleft/gpl.html
+ *  \par
+ *              You should have received a copy of the GNU Lesser General Public License along
+ *              with this library; if not, write to the Free Software Foundation, Inc.,
+ *              51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *//***********************************************************************************************/
+
+#include <stdio.h>
+#include "MLX90614.h"
+#include "MLX90614Sim.h"
+
+#define WORKSLICE   10          /**< Simulated work per loop iteration (us) */
+#define RUNTIME     1000000UL   /**< Simulated run time (us) */
+
+int main(void) {
+    MLX90614SimDevice dev;
+    MLX90614SimBus bus;
+    bus.attach(dev);
+    MLX90614 mlx(MLX90614_I2CDEFAULTADDR, &bus);
+    mlx.begin();
+
+    // Bit identical results for every raw value and unit.
+    for(uint32_t raw = 0; raw < 0x10000; raw += 7) {
+        dev.setRam(MLX90614_TOBJ1, raw);
+        for(int u = MLX90614::MLX90614_TK; u <= MLX90614::MLX90614_TF; u++) {
+            MLX90614::tempUnit_t unit = (MLX90614::tempUnit_t)u;
+            double a = mlx.readTemp(MLX90614::MLX90614_SRC01, unit);
+            uint8_t ea = mlx.rwError;
+            mlx.startRead(MLX90614::MLX90614_SRC01, unit);
+            while(mlx.poll() != MLX90614::MLX90614_DONE) hostAdvance(1);
+            double b = mlx.result();
+            if(memcmp(&a, &b, sizeof(a)) || (ea != mlx.rwError)) {
+                printf("mismatch raw=%04X unit=%d\n", raw, u);
+                return 1;
+            }
+        }
+    }
+    dev.setTemp(MLX90614_TOBJ1, 310.15);
+
+    // Blocking loop.
+    uint32_t work = 0, reads = 0, t0 = micros();
+    while((uint32_t)(micros() - t0) < RUNTIME) {
+        volatile double t = mlx.readTemp();
+        (void)t;
+        ++reads;
+        hostAdvance(WORKSLICE);
+        ++work;
+    }
+    printf("blocking   %6u reads  %6u work slices  %5.1f%% of loop time free\n",
+           reads, work, 100.0 * work * WORKSLICE / RUNTIME);
+
+    // Asynchronous loop.
+    uint32_t bwork = work;
+    work = reads = 0;
+    t0 = micros();
+    mlx.startRead();
+    while((uint32_t)(micros() - t0) < RUNTIME) {
+        if(mlx.poll() == MLX90614::MLX90614_DONE) {
+            volatile double t = mlx.result();
+            (void)t;
+            ++reads;
+            mlx.startRead();
+        }
+        hostAdvance(WORKSLICE);
+        ++work;
+    }
+    printf("async      %6u reads  %6u work slices  %5.1f%% of loop time free\n",
+           reads, work, 100.0 * work * WORKSLICE / RUNTIME);
+    printf("loop time freed per read %.1f us (bus transfers still block in the transport)\n",
+           (double)(work - bwork) * WORKSLICE / reads);
+    return 0;
+}
@@ -0,0 +1,129 @@
+/***********************************************************************************************//**
+ *  \brief      MLX90614 host benchmark - batch conversion of raw words.
+ *  \par
+ *  \par        Details
+ *              Converts a log of raw words (1% error words) to &deg;C and &deg;F with the per
+ *              sample rawToTemp() path and with MLX90614Batch using each kernel the processor
+ *              supports, in float and fixed point. Every kernel is first checked against
+ *              rawToTemp()/rawToFixed() over all 65536 possible words.
+ *  \par        Build
+ *              See extras/README.md.
+ *
+ *  \file       BENCH_BATCH.CPP
+ *  \author     J. F. Fitter <jfitter@eagleairaust.com.au>
+ *  \version    1.0
+ *  \date       2014-2017
+ *  \copyright  Copyright &copy; 2017 John Fitter.  All right reserved.
+ *
+ *  \par        License
+ *              This program is free software; you can redistribute it and/or modify it under
+ *              the terms of the GNU Lesser General Public License as published by the Free
+ *              Software Foundation; either version 2.1 of the License, or (at your option)
+ *              any later version.
+ *  \par
+ *              This Program is distributed in the hope that it will be useful, but WITHOUT ANY
+ *              WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *              PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details
+ *              at http://www.gnu.org/copyleft/gpl.html
+ *  \par
+ *              You should have received a copy of the GNU Lesser General Public License along
+ *              with this library; if not, write to the Free Software Foundation, Inc.,
+ *              51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *//***********************************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <chrono>
+#include <vector>
+#include "MLX90614.h"
+#include "MLX90614Batch.h"
+
+#define NWORDS      (1 << 22)   /**< Log size (words) */
+#define REPEAT      8           /**< Passes over the log per measurement */
+
+static volatile double sink;
+static const char* KNAME[] = {"scalar", "sse2", "avx2"};
+
+/** Check a kernel over every possible word. Return the number of mismatches. */
+static uint32_t check(MLX90614& mlx) {
+    std::vector<uint16_t> raw(65536 + 5);                   // Odd length, exercises the tail
+    std::vector<float> f(raw.size());
+    std::vector<int32_t> x(raw.size());
+    std::vector<uint8_t> m((raw.size() + 7) / 8), mx(m.size());
+    uint32_t bad = 0;
+
+    for(size_t i = 0; i < raw.size(); i++) raw[i] = (uint16_t)i;
+    for(int u = 0; u < 3; u++) {
+        MLX90614::tempUnit_t unit = (MLX90614::tempUnit_t)u;
+        size_t ne = MLX90614Batch::toFloat(raw.data(), f.data(), m.data(), raw.size(), unit);
+        size_t nx = MLX90614Batch::toFixed(raw.data(), x.data(), mx.data(), raw.size(), unit);
+        if(ne != 32768 || nx != ne) ++bad;
+        for(size_t i = 0; i < raw.size(); i++) {
+            boolean err = raw[i] & 0x8000;
+            if(((m[i >> 3] >> (i & 7)) & 1) != err || ((mx[i >> 3] >> (i & 7)) & 1) != err) ++bad;
+            if(err) {
+                if(!isnan(f[i]) || x[i] != MLX90614_FIXEDINVALID) ++bad;
+            } else {
+                if(fabs(f[i] - mlx.rawToTemp(raw[i], unit)) > 1e-3) ++bad;
+                if(x[i] != MLX90614::rawToFixed(raw[i], unit)) ++bad;
+            }
+        }
+    }
+    return bad;
+}
+
+/** Time one conversion, return Mwords/s. */
+template <typename F> static double rate(F fn) {
+    auto t0 = std::chrono::steady_clock::now();
+    for(int r = 0; r < REPEAT; r++) fn();
+    auto t1 = std::chrono::steady_clock::now();
+    return (double)NWORDS * REPEAT / std::chrono::duration<double, std::micro>(t1 - t0).count();
+}
+
+int main(void) {
+    MLX90614 mlx;
+    std::vector<uint16_t> raw(NWORDS);
+    std::vector<float> f(NWORDS);
+    std::vector<int32_t> x(NWORDS);
+    std::vector<uint8_t> m(NWORDS / 8);
+    MLX90614Batch::kernel_t best = MLX90614Batch::kernel();
+    uint32_t bad = 0;
+
+    srand(1);
+    for(size_t i = 0; i < NWORDS; i++)
+        raw[i] = (rand() % 100) ? 0x3A00 + rand() % 0x800 : 0x8000 | rand();
+
+    printf("conversion                 degC Mwords/s   degF Mwords/s\n");
+    double base[2];
+    for(int u = 0; u < 2; u++) {
+        MLX90614::tempUnit_t unit = u ? MLX90614::MLX90614_TF : MLX90614::MLX90614_TC;
+        base[u] = rate([&] {
+            double s = 0;
+            for(size_t i = 0; i < NWORDS; i++) if(!(raw[i] & 0x8000)) s += mlx.rawToTemp(raw[i], unit);
+            sink = s;
+        });
+    }
+    printf("rawToTemp() per sample     %8.1f        %8.1f\n", base[0], base[1]);
+
+    double fastest = 0;
+    for(int k = 0; k <= MLX90614Batch::MLX90614_AVX2; k++) {
+        if(!MLX90614Batch::setKernel((MLX90614Batch::kernel_t)k)) continue;
+        uint32_t b = check(mlx);
+        bad += b;
+        double rf[2], rx[2];
+        for(int u = 0; u < 2; u++) {
+            MLX90614::tempUnit_t unit = u ? MLX90614::MLX90614_TF : MLX90614::MLX90614_TC;
+            rf[u] = rate([&] {sink = MLX90614Batch::toFloat(raw.data(), f.data(), m.data(), NWORDS, unit);});
+            rx[u] = rate([&] {sink = MLX90614Batch::toFixed(raw.data(), x.data(), m.data(), NWORDS, unit);});
+        }
+        if(rf[0] > fastest) fastest = rf[0];
+        printf("%-6s float              %8.1f        %8.1f      %s\n", KNAME[k], rf[0], rf[1],
+               b ? "MISMATCH" : "checked");
+        printf("%-6s fixed              %8.1f        %8.1f\n", KNAME[k], rx[0], rx[1]);
+    }
+    MLX90614Batch::setKernel(best);
+    printf("default kernel %s, %.1fx the per sample path (degC float)\n", KNAME[best], fastest / base[0]);
+    return bad ? 1 : 0;
+}
@@ -0,0 +1,85 @@
+/***********************************************************************************************//**
+ *  \brief      MLX90614 host benchmark - CRC8 bitwise vs table vs nibble table.
+ *  \par
+ *  \par        Details
+ *              Checks that the three CRC8 update algorithms agree for every (crc, data) pair,
+ *              then reports the cost per byte of each along with the flash it needs.
+ *  \par        Build
+ *              See extras/README.md.
+ *
+ *  \file       BENCH_CRC8.CPP
+ *  \author     J. F. Fitter <jfitter@eagleairaust.com.au>
+ *  \version    1.0
+ *  \date       2014-2017
+ *  \copyright  Copyright &copy; 2017 John Fitter.  All right reserved.
+ *
+ *  \par        License
+ *              This program is free software; you can redistribute it and/or modify it under
+ *              the terms of the GNU Lesser General Public License as published by the Free
+ *              Software Foundation; either version 2.1 of the License, or (at your option)
+ *              any later version.
+ *  \par
+ *              This Program is distributed in the hope that it will be useful, but WITHOUT ANY
+ *              WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *              PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details
+ *              at http://www.gnu.org/copyleft/gpl.html
+ *  \par
+ *              You should have received a copy of the GNU Lesser General Public License along
+ *              with this library; if not, write to the Free Software Foundation, Inc.,
+ *              51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *//***********************************************************************************************/
+
+#include <stdio.h>
+#include <chrono>
+#include "Crc8.h"
+
+static uint8_t buf[4096];
+
+/**
+ *  \brief            Time one update algorithm over the buffer.
+ *  \return           Nanoseconds per byte.
+ */
+template<typename Fn> static double timeit(Fn fn, uint8_t& crc) {
+    const int reps = 2000;
+
+    auto t0 = std::chrono::steady_clock::now();
+    for(int r = 0; r < reps; r++)
+        for(size_t i = 0; i < sizeof(buf); i++) crc = fn(crc, buf[i]);
+    auto t1 = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(t1 - t0).count() / ((double)reps * sizeof(buf));
+}
+
+int main(void) {
+
+    // All three algorithms must agree everywhere.
+    for(int c = 0; c < 256; c++)
+        for(int d = 0; d < 256; d++) {
+            uint8_t b = CRC8::updateBitwise(c, d), t = CRC8::updateTable(c, d), n = CRC8::updateNibble(c, d);
+            if((b != t) || (b != n)) {
+                printf("mismatch crc=%02X data=%02X bitwise=%02X table=%02X nibble=%02X\n", c, d, b, t, n);
+                return 1;
+            }
+        }
+
+    // SMBus PEC check value: CRC-8 of "123456789" is F4h.
+    CRC8 crc;
+    if(crc.crc8((const uint8_t*)"123456789", 9) != 0xF4) {
+        printf("check value mismatch %02X\n", crc.crc8());
+        return 1;
+    }
+
+    uint32_t seed = 1;
+    for(size_t i = 0; i < sizeof(buf); i++) buf[i] = (seed = seed * 1103515245 + 12345) >> 16;
+
+    uint8_t cb = 0, ct = 0, cn = 0;
+    double nb = timeit([](uint8_t c, uint8_t d) {return CRC8::updateBitwise(c, d);}, cb);
+    double nt = timeit([](uint8_t c, uint8_t d) {return CRC8::updateTable(c, d);}, ct);
+    double nn = timeit([](uint8_t c, uint8_t d) {return CRC8::updateNibble(c, d);}, cn);
+
+    printf("algorithm   table bytes      ns/byte   speedup\n");
+    printf("bitwise     %11d %12.2f %9.2f\n", 0,   nb, 1.0);
+    printf("nibble      %11d %12.2f %9.2f\n", 16,  nn, nb / nn);
+    printf("table       %11d %12.2f %9.2f\n", 256, nt, nb / nt);
+    return ((cb == ct) && (cb == cn)) ? 0 : 1;
+}
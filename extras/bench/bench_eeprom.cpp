@@ -0,0 +1,140 @@
+/***********************************************************************************************//**
+ *  \brief      MLX90614 host benchmark - EEPROM writes, EEBUSY polling and the write queue.
+ *  \par
+ *  \par        Details
+ *              Sets the emissivity of ten simulated devices on one bus, first with blocking
+ *              writeEEProm() calls (which now poll EEBUSY) and then with one MLX90614EEQueue per
+ *              device polled round robin, for two simulated erase/write times. The fixed delay
+ *              implementation needed at least 10ms per write. A filter change with two setters
+ *              is compared with one configuration transaction. Finally a write to a factory
+ *              protected word checks that a failed verify is reported per ticket.
+ *  \par        Build
+ *              See extras/README.md.
+ *
+ *  \file       BENCH_EEPROM.CPP
+ *  \author     J. F. Fitter <jfitter@eagleairaust.com.au>
+ *  \version    1.0
+ *  \date       2014-2017
+ *  \copyright  Copyright &copy; 2017 John Fitter.  All right reserved.
+ *
+ *  \par        License
+ *              This program is free software; you can redistribute it and/or modify it under
+ *              the terms of the GNU Lesser General Public License as published by the Free
+ *              Software Foundation; either version 2.1 of the License, or (at your option)
+ *              any later version.
+ *  \par
+ *              This Program is distributed in the hope that it will be useful, but WITHOUT ANY
+ *              WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *              PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details
+ *              at http://www.gnu.org/copyleft/gpl.html
+ *  \par
+ *              You should have received a copy of the GNU Lesser General Public License along
+ *              with this library; if not, write to the Free Software Foundation, Inc.,
+ *              51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *//***********************************************************************************************/
+
+#include <stdio.h>
+#include "MLX90614.h"
+#include "MLX90614EEQueue.h"
+#include "MLX90614Sim.h"
+
+#define NDEV    10
+
+static MLX90614SimDevice* dev[NDEV];
+static MLX90614* mlx[NDEV];
+static MLX90614EEQueue* queue[NDEV];
+
+/**
+ *  \brief              Run both write strategies with a given simulated erase/write time.
+ */
+static void run(uint32_t eeTime) {
+    static uint16_t emiss = 0xF000;
+    uint32_t t0, tblk, tq;
+
+    for(int i = 0; i < NDEV; i++) dev[i]->eeTime = eeTime;
+
+    t0 = micros();
+    ++emiss;
+    for(int i = 0; i < NDEV; i++) mlx[i]->writeEEProm(MLX90614_EMISS, emiss);
+    tblk = micros() - t0;
+
+    t0 = micros();
+    ++emiss;
+    for(int i = 0; i < NDEV; i++) queue[i]->push(MLX90614_EMISS, emiss);
+    for(boolean busy = true; busy; ) {
+        busy = false;
+        for(int i = 0; i < NDEV; i++) busy |= queue[i]->poll();
+    }
+    tq = micros() - t0;
+
+    printf("Tee %4u us   fixed delay >= %6u us   blocking/EEBUSY %6u us   queued %6u us\n",
+           eeTime, NDEV * 10000, tblk, tq);
+}
+
+int main(void) {
+    MLX90614SimBus bus;
+
+    for(int i = 0; i < NDEV; i++) {
+        dev[i] = new MLX90614SimDevice(0x10 + i);
+        bus.attach(*dev[i]);
+        mlx[i] = new MLX90614(0x10 + i, &bus);
+        mlx[i]->begin();
+        queue[i] = new MLX90614EEQueue(*mlx[i]);
+    }
+    printf("Emissivity write to %d devices on one 100kHz bus\n", NDEV);
+    run(MLX90614SIM_TEEWRITE);
+    run(2000);
+
+    for(int i = 0; i < NDEV; i++)
+        if(dev[i]->getEEProm(MLX90614_EMISS) != 0xF004) {
+            printf("device %d emissivity %04X\n", i, dev[i]->getEEProm(MLX90614_EMISS));
+            return 1;
+        }
+
+    // Changing both filters with two setters versus one configuration transaction.
+    dev[1]->eeTime = MLX90614SIM_TEEWRITE;
+    uint32_t w0 = dev[1]->eeWrites + dev[1]->eeErases, t0 = micros();
+    mlx[1]->setIIRcoeff(5);
+    mlx[1]->setFIRcoeff(6);
+    uint32_t w1 = dev[1]->eeWrites + dev[1]->eeErases, t1 = micros();
+    mlx[1]->beginConfig().setIIRcoeff(2).setFIRcoeff(7).commit();
+    uint32_t w2 = dev[1]->eeWrites + dev[1]->eeErases, t2 = micros();
+    printf("IIR+FIR change: setters %u us, %u erase/write cycles   beginConfig() %u us, %u cycles\n",
+           t1 - t0, w1 - w0, t2 - t1, w2 - w1);
+
+    // One bad flags read falls back to the fixed wait for that write only.
+    dev[2]->eeTime = 2000;
+    uint32_t e0 = dev[2]->eeErases;
+    mlx[2]->eeStart(MLX90614_EMISS, 0xF200);
+    while(dev[2]->eeErases == e0) mlx[2]->eePoll();
+    dev[2]->injectFault(MLX90614SIM_BADPEC, 1);
+    t0 = micros();
+    while(mlx[2]->eePoll() != MLX90614::MLX90614_DONE) hostAdvance(100);
+    t1 = micros();
+    mlx[2]->eeStart(MLX90614_EMISS, 0xF201);
+    while(mlx[2]->eePoll() != MLX90614::MLX90614_DONE) hostAdvance(100);
+    t2 = micros();
+    printf("bad flags read: that write %u us, next write %u us\n", t1 - t0, t2 - t1);
+    if((t2 - t1 >= 2 * MLX90614_TEEWRITE) || (dev[2]->getEEProm(MLX90614_EMISS) != 0xF201)) return 1;
+
+    // Polling with no write in progress keeps the error flags of the last read.
+    dev[3]->injectFault(MLX90614SIM_NACKADDR, 1);
+    mlx[3]->readTemp();
+    uint8_t readErr = mlx[3]->rwError;
+    boolean idle = (mlx[3]->eePoll() == MLX90614::MLX90614_IDLE);
+    printf("idle eePoll(): read error %02Xh, after poll %02Xh\n", readErr, (uint8_t)mlx[3]->rwError);
+    if(!readErr || !idle || (mlx[3]->rwError != readErr)) return 1;
+
+    // Factory protected word - the write is ignored by the device so the verify fails.
+    uint8_t ok, bad, err = 0;
+    queue[0]->push(MLX90614_EMISS, 0xF100, &ok);
+    queue[0]->push(0x10, 0x1234, &bad);
+    while(queue[0]->poll());
+    queue[0]->status(ok, &err);
+    printf("ticket %u err=%02Xh   ", ok, err);
+    if(err) return 1;
+    queue[0]->status(bad, &err);
+    printf("ticket %u err=%02Xh (protected word)\n", bad, err);
+    return (err & MLX90614_EECORRUPT) ? 0 : 1;
+}
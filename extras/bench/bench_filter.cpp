@@ -0,0 +1,126 @@
+/***********************************************************************************************//**
+ *  \brief      MLX90614 host benchmark - sample filter chain.
+ *  \par
+ *  \par        Details
+ *              Feeds a noisy temperature (with occasional spikes) and a step through each
+ *              filter stage and reports the residual noise, the settling time after the step
+ *              and the host cost per sample.
+ *  \par        Build
+ *              See extras/README.md.
+ *
+ *  \file       BENCH_FILTER.CPP
+ *  \author     J. F. Fitter <jfitter@eagleairaust.com.au>
+ *  \version    1.0
+ *  \date       2014-2017
+ *  \copyright  Copyright &copy; 2017 John Fitter.  All right reserved.
+ *
+ *  \par        License
+ *              This program is free software; you can redistribute it and/or modify it under
+ *              the terms of the GNU Lesser General Public License as published by the Free
+ *              Software Foundation; either version 2.1 of the License, or (at your option)
+ *              any later version.
+ *  \par
+ *              This Program is distributed in the hope that it will be useful, but WITHOUT ANY
+ *              WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *              PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details
+ *              at http://www.gnu.org/copyleft/gpl.html
+ *  \par
+ *              You should have received a copy of the GNU Lesser General Public License along
+ *              with this library; if not, write to the Free Software Foundation, Inc.,
+ *              51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *//***********************************************************************************************/
+
+#include <stdio.h>
+#include <chrono>
+#include <random>
+#include "MLX90614Filter.h"
+#include "MLX90614Sim.h"
+
+static const uint32_t N = 20000;                            // Samples, step at N / 2
+static float input[N];
+
+/**
+ *  \brief  Run one filter over the input.
+ *          Prints the residual RMS noise (first half), the samples taken after the step to come
+ *          within 0.5 of the new value and the host cost.
+ */
+static void run(const char* name, MLX90614Filter& f) {
+    double se = 0;
+    uint32_t settle = 0;
+
+    f.reset();
+    auto t0 = std::chrono::steady_clock::now();
+    for(uint32_t i = 0; i < N; i++) {
+        float y = f.update(input[i]);
+        if(i < N / 2) {
+            if(i >= 100) se += (y - 25.0) * (y - 25.0);
+        } else if(!settle && (y > 34.5)) settle = i - N / 2 + 1;
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    double ns = std::chrono::duration<double, std::nano>(t1 - t0).count() / N;
+    printf("%-22s %8.4f %8u %8.1f\n", name, sqrt(se / (N / 2 - 100)), settle, ns);
+}
+
+int main(void) {
+    std::mt19937 gen(1);
+    std::normal_distribution<float> noise(0, 0.2);
+
+    // 25C then 35C, 0.2C RMS noise, 1% spikes of +5C.
+    for(uint32_t i = 0; i < N; i++) {
+        input[i] = (i < N / 2 ? 25.0 : 35.0) + noise(gen);
+        if(gen() % 100 == 0) input[i] += 5.0;
+    }
+
+    MLX90614MovingAvg<16> avg;
+    MLX90614Median<9> med;
+    MLX90614ExpFilter ema(0.1);
+    MLX90614Kalman kal(0.0005, 0.04);
+    MLX90614Median<5> med2;
+    MLX90614ExpFilter ema2(0.1);
+    MLX90614FilterChain<2> chain;
+    chain.add(med2);
+    chain.add(ema2);
+
+    printf("filter                  rms (C)   settle    ns/op\n");  // settle = samples to 0.5C
+    MLX90614FilterChain<1> none;
+    run("none", none);
+    run("moving average 16", avg);
+    run("median 9", med);
+    run("exponential 0.1", ema);
+    run("kalman", kal);
+    run("median 5 + exp 0.1", chain);
+
+    // Read through the driver. Error samples are held, not filtered.
+    MLX90614SimDevice dev;
+    MLX90614SimBus bus;
+    bus.attach(dev);
+    MLX90614 mlx(MLX90614_I2CDEFAULTADDR, &bus);
+    mlx.begin();
+    chain.reset();
+    dev.injectFault(MLX90614SIM_BADPEC, 1);
+    float unprimed = chain.read(mlx);
+    float t = 0;
+    for(uint8_t i = 0; i < 20; i++) t = chain.read(mlx);
+    dev.injectFault(MLX90614SIM_BADPEC, 1);
+    float held = chain.read(mlx);
+    printf("\ndriver read %.2f C, held on PEC error %.2f C, PEC error before priming %.2f C\n",
+           t, held, unprimed);
+
+    // Moving average of a constant with a large offset - the running sum must not drift.
+    MLX90614MovingAvg<16> drift;
+    float d = 0;
+    for(uint32_t i = 0; i < 1000000; i++) d = drift.update(i & 1 ? 300.1 : 0.1);
+    d = 0;
+    for(uint8_t i = 0; i < 16; i++) d = drift.update(0.1);
+    printf("moving average after 1M samples, then a window of 0.1: %.6f\n", d);
+
+    // Self check - median output is exact for a constant input.
+    MLX90614Median<9> m;
+    float v = 0;
+    for(uint8_t i = 0; i < 20; i++) v = m.update(i == 10 ? 99.0 : 1.5);
+    boolean ok = (v == 1.5) && (fabs(t - 37.0) < 0.01) && (held == t) && isnan(unprimed)
+              && (fabs(d - 0.1) < 1e-6);
+    printf("\nself check %s\n", ok ? "passed" : "FAILED");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,90 @@
+/***********************************************************************************************//**
+ *  \brief      MLX90614 host benchmark - fixed point versus double temperature conversion.
+ *  \par
+ *  \par        Details
+ *              Checks that rawToFixed() equals the double conversion rounded to the nearest
+ *              hundredth for every raw value and unit, then times both conversions and both
+ *              read paths. On a host the FPU makes the difference small; on AVR the double path
+ *              calls the soft-float library.
+ *  \par        Build
+ *              See extras/README.md.
+ *
+ *  \file       BENCH_FIXED.CPP
+ *  \author     J. F. Fitter <jfitter@eagleairaust.com.au>
+ *  \version    1.0
+ *  \date       2014-2017
+ *  \copyright  Copyright &copy; 2017 John Fitter.  All right reserved.
+ *
+ *  \par        License
+ *              This program is free software; you can redistribute it and/or modify it under
+ *              the terms of the GNU Lesser General Public License as published by the Free
+ *              Software Foundation; either version 2.1 of the License, or (at your option)
+ *              any later version.
+ *  \par
+ *              This Program is distributed in the hope that it will be useful, but WITHOUT ANY
+ *              WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *              PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details
+ *              at http://www.gnu.org/copyleft/gpl.html
+ *  \par
+ *              You should have received a copy of the GNU Lesser General Public License along
+ *              with this library; if not, write to the Free Software Foundation, Inc.,
+ *              51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *//***********************************************************************************************/
+
+#include <stdio.h>
+#include <chrono>
+#include "MLX90614.h"
+#include "MLX90614Sim.h"
+
+static volatile double  dsink;
+static volatile int32_t isink;
+
+/** Compile time conversions. */
+static_assert(MLX90614::centiKtoC(MLX90614::rawToCentiK(13657)) == -1, "centi-C");
+static_assert(MLX90614::centiCtoF(-1778) == 0, "centi-F");
+static_assert(MLX90614::centiCtoF(10000) == 21200, "centi-F");
+
+int main(void) {
+    MLX90614SimDevice dev;
+    MLX90614SimBus bus;
+    bus.attach(dev);
+    MLX90614 mlx(MLX90614_I2CDEFAULTADDR, &bus);
+    mlx.begin();
+
+    for(uint32_t raw = 0; raw < 0x8000; raw++)
+        for(int u = MLX90614::MLX90614_TK; u <= MLX90614::MLX90614_TF; u++) {
+            MLX90614::tempUnit_t unit = (MLX90614::tempUnit_t)u;
+            int32_t f = MLX90614::rawToFixed(raw, unit);
+            int32_t d = lround(mlx.rawToTemp(raw, unit) * 100.0);
+            if(f != d) {
+                printf("mismatch raw=%04X unit=%d fixed=%d double=%d\n", raw, u, f, d);
+                return 1;
+            }
+        }
+
+    const uint32_t N = 1 << 15;
+    const int R = 200;
+    const char* units[] = {"K", "C", "F"};
+    for(int u = MLX90614::MLX90614_TK; u <= MLX90614::MLX90614_TF; u++) {
+        MLX90614::tempUnit_t unit = (MLX90614::tempUnit_t)u;
+        auto t0 = std::chrono::steady_clock::now();
+        for(int r = 0; r < R; r++) for(uint32_t raw = 0; raw < N; raw++) dsink = mlx.rawToTemp(raw, unit);
+        auto t1 = std::chrono::steady_clock::now();
+        for(int r = 0; r < R; r++) for(uint32_t raw = 0; raw < N; raw++) isink = MLX90614::rawToFixed(raw, unit);
+        auto t2 = std::chrono::steady_clock::now();
+        printf("convert %s   double %6.2f ns   fixed %6.2f ns\n", units[u],
+               std::chrono::duration<double, std::nano>(t1 - t0).count() / (N * R),
+               std::chrono::duration<double, std::nano>(t2 - t1).count() / (N * R));
+    }
+
+    auto t0 = std::chrono::steady_clock::now();
+    for(uint32_t i = 0; i < N; i++) dsink = mlx.readTemp();
+    auto t1 = std::chrono::steady_clock::now();
+    for(uint32_t i = 0; i < N; i++) isink = mlx.readTempFixed();
+    auto t2 = std::chrono::steady_clock::now();
+    printf("read C      double %6.2f ns   fixed %6.2f ns\n",
+           std::chrono::duration<double, std::nano>(t1 - t0).count() / N,
+           std::chrono::duration<double, std::nano>(t2 - t1).count() / N);
+    return 0;
+}
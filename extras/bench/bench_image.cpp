@@ -0,0 +1,140 @@
+/***********************************************************************************************//**
+ *  \brief      MLX90614 host benchmark - EEPROM image programming.
+ *  \par
+ *  \par        Details
+ *              Restores a full EEPROM image on a simulated device with 0...9 words changed and
+ *              compares the bus time of a blind erase/write of every customer word, the example
+ *              sketch loop (writeEEProm() per word) and writeImage(), all on a cold shadow.
+ *  \par        Build
+ *              See extras/README.md.
+ *
+ *  \file       BENCH_IMAGE.CPP
+ *  \author     J. F. Fitter <jfitter@eagleairaust.com.au>
+ *  \version    1.0
+ *  \date       2014-2017
+ *  \copyright  Copyright &copy; 2017 John Fitter.  All right reserved.
+ *
+ *  \par        License
+ *              This program is free software; you can redistribute it and/or modify it under
+ *              the terms of the GNU Lesser General Public License as published by the Free
+ *              Software Foundation; either version 2.1 of the License, or (at your option)
+ *              any later version.
+ *  \par
+ *              This Program is distributed in the hope that it will be useful, but WITHOUT ANY
+ *              WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *              PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details
+ *              at http://www.gnu.org/copyleft/gpl.html
+ *  \par
+ *              You should have received a copy of the GNU Lesser General Public License along
+ *              with this library; if not, write to the Free Software Foundation, Inc.,
+ *              51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *//***********************************************************************************************/
+
+#include <stdio.h>
+#include "MLX90614.h"
+#include "MLX90614Sim.h"
+
+#define TEEDELAY    5000        /**< Data sheet erase/write time (us) */
+
+static const uint8_t WORDS[] = {0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x0E, 0x0F, 0x19};
+static const uint8_t NWORDS = sizeof(WORDS);
+
+/** Write one word with a raw SMBus frame, as a tool without a driver would. */
+static void rawWrite(MLX90614Bus& bus, uint8_t reg, uint16_t data) {
+    CRC8 crc(MLX90614_CRC8POLY);
+    uint8_t buf[4] = {(uint8_t)(reg | 0x20), lowByte(data), highByte(data), 0};
+
+    crc.crc8(MLX90614_I2CDEFAULTADDR << 1);
+    buf[3] = crc.crc8(buf, 3);
+    bus.transmit(MLX90614_I2CDEFAULTADDR, buf, 4);
+}
+
+/** Change the first n customer words of the device away from the image. */
+static void disturb(MLX90614SimDevice& dev, const uint16_t* image, uint8_t n) {
+    for(uint8_t i = 0; i < NWORDS; i++)
+        dev.setEEProm(WORDS[i], i < n ? image[WORDS[i]] ^ 0x0101 : image[WORDS[i]]);
+}
+
+/** Return true if the device holds the image. */
+static boolean matches(MLX90614SimDevice& dev, const uint16_t* image) {
+    for(uint8_t i = 0; i < MLX90614_EEWORDS; i++) if(dev.getEEProm(i) != image[i]) return false;
+    return true;
+}
+
+int main(void) {
+    const uint8_t CHANGES[] = {0, 1, 3, NWORDS};
+    MLX90614SimDevice dev;
+    MLX90614SimBus bus;
+    bus.attach(dev);
+    MLX90614 mlx(MLX90614_I2CDEFAULTADDR, &bus);
+    mlx.begin();
+
+    uint16_t image[MLX90614_EEWORDS];
+    uint8_t err = mlx.readImage(image);
+    uint32_t bad = err ? 1 : 0;
+
+    printf("changed   blind erase/write    writeEEProm loop     writeImage\n");
+    for(uint8_t c = 0; c < sizeof(CHANGES); c++) {
+        uint8_t n = CHANGES[c];
+        uint32_t t0, tx0, us[3], tx[3];
+
+        // Blind: erase, wait, write, wait for every customer word.
+        disturb(dev, image, n);
+        t0 = micros(); tx0 = bus.transactions;
+        for(uint8_t i = 0; i < NWORDS; i++) {
+            rawWrite(bus, WORDS[i], 0);
+            delayMicroseconds(TEEDELAY);
+            rawWrite(bus, WORDS[i], image[WORDS[i]]);
+            delayMicroseconds(TEEDELAY);
+        }
+        us[0] = micros() - t0; tx[0] = bus.transactions - tx0;
+        if(!matches(dev, image)) ++bad;
+
+        // Example sketch: one writeEEProm() per word on a cold shadow.
+        disturb(dev, image, n);
+        mlx.invalidate();
+        t0 = micros(); tx0 = bus.transactions;
+        for(uint8_t i = 0; i < NWORDS; i++) mlx.writeEEProm(WORDS[i], image[WORDS[i]]);
+        us[1] = micros() - t0; tx[1] = bus.transactions - tx0;
+        if(!matches(dev, image)) ++bad;
+
+        // Image: only the differences are programmed.
+        disturb(dev, image, n);
+        mlx.invalidate();
+        MLX90614::imageReport_t rep;
+        t0 = micros(); tx0 = bus.transactions;
+        err = mlx.writeImage(image, rep);
+        us[2] = micros() - t0; tx[2] = bus.transactions - tx0;
+        if(err || !matches(dev, image) || rep.failed || rep.skipped ||
+           __builtin_popcount(rep.written) != n || rep.written != rep.differ) ++bad;
+
+        printf("%4u      %7.1f ms %4u tx    %7.1f ms %4u tx    %7.1f ms %4u tx\n", n,
+               us[0] / 1000.0, tx[0], us[1] / 1000.0, tx[1], us[2] / 1000.0, tx[2]);
+    }
+
+    // Protected words are reported after a readImage(), never written.
+    uint16_t alt[MLX90614_EEWORDS];
+    MLX90614::imageReport_t rep;
+    for(uint8_t i = 0; i < MLX90614_EEWORDS; i++) alt[i] = image[i];
+    alt[0x10] ^= 1;
+    alt[0x04] ^= 1;
+    mlx.readImage(image);
+    mlx.writeImage(alt, rep);
+    printf("protected word: differ %08lX written %08lX skipped %08lX failed %08lX\n",
+           (unsigned long)rep.differ, (unsigned long)rep.written, (unsigned long)rep.skipped,
+           (unsigned long)rep.failed);
+    if(rep.skipped != (1UL << 0x10) || rep.written != (1UL << 0x04) ||
+       dev.getEEProm(0x10) != image[0x10]) ++bad;
+
+    // An all ones mask cannot unprotect the calibration words.
+    alt[0x04] ^= 1;
+    mlx.writeImage(alt, rep, 0xFFFFFFFFUL);
+    printf("all ones mask:  differ %08lX written %08lX skipped %08lX failed %08lX\n",
+           (unsigned long)rep.differ, (unsigned long)rep.written, (unsigned long)rep.skipped,
+           (unsigned long)rep.failed);
+    if(rep.skipped != (1UL << 0x10) || rep.written != (1UL << 0x04) ||
+       dev.getEEProm(0x10) != image[0x10]) ++bad;
+
+    return bad ? 1 : 0;
+}
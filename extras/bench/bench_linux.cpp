@@ -0,0 +1,120 @@
+/***********************************************************************************************//**
+ *  \brief      MLX90614 host benchmark - Linux i2c-dev transport.
+ *  \par
+ *  \par        Details
+ *              Runs the driver over MLX90614LinuxBus with the fake system call layer routed to
+ *              the simulated device, using the combined I2C_RDWR path and the SMBus PEC path,
+ *              and compares system calls, bus time and host cost per read with the split
+ *              transaction used on Arduino. Also checks errors are reported the same way.
+ *  \par        Build
+ *              See extras/README.md.
+ *
+ *  \file       BENCH_LINUX.CPP
+ *  \author     J. F. Fitter <jfitter@eagleairaust.com.au>
+ *  \version    1.0
+ *  \date       2014-2017
+ *  \copyright  Copyright &copy; 2017 John Fitter.  All right reserved.
+ *
+ *  \par        License
+ *              This program is free software; you can redistribute it and/or modify it under
+ *              the terms of the GNU Lesser General Public License as published by the Free
+ *              Software Foundation; either version 2.1 of the License, or (at your option)
+ *              any later version.
+ *  \par
+ *              This Program is distributed in the hope that it will be useful, but WITHOUT ANY
+ *              WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *              PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details
+ *              at http://www.gnu.org/copyleft/gpl.html
+ *  \par
+ *              You should have received a copy of the GNU Lesser General Public License along
+ *              with this library; if not, write to the Free Software Foundation, Inc.,
+ *              51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *//***********************************************************************************************/
+
+#include <stdio.h>
+#include <chrono>
+#include "MLX90614LinuxBus.h"
+
+static volatile double sink;
+
+/**
+ *  \brief  Read N temperatures and print the cost, then check fault reporting.
+ *  \return True if the faults were reported correctly.
+ */
+static boolean run(const char* name, MLX90614& mlx, MLX90614SimDevice& dev, const uint32_t* calls) {
+    const uint32_t N = 200000;
+
+    uint32_t c0 = calls ? *calls : 0, v0 = micros();
+    auto t0 = std::chrono::steady_clock::now();
+    for(uint32_t i = 0; i < N; i++) sink = mlx.readTemp();
+    auto t1 = std::chrono::steady_clock::now();
+    double ns = std::chrono::duration<double, std::nano>(t1 - t0).count() / N;
+    printf("%-22s %8.1f %12.1f ", name, ns, (double)(micros() - v0) / N);
+    if(calls) printf("%10.2f\n", (double)(*calls - c0) / N);
+    else printf("         2 (hand port: write + read)\n");
+
+    dev.injectFault(MLX90614SIM_BADPEC, 1);
+    sink = mlx.readTemp();
+    boolean ok = mlx.rwError == MLX90614_RXCRC;
+    dev.injectFault(MLX90614SIM_NACKADDR, 1);
+    sink = mlx.readTemp();
+    ok = ok && (mlx.rwError & MLX90614_TXADDRNACK);
+    sink = mlx.readTemp();
+    ok = ok && !mlx.rwError && (fabs(sink - 37.0) < 0.01);
+
+    // EEPROM write and read back through the transport.
+    mlx.setEmissivity(0.9);
+    ok = ok && !mlx.rwError;
+    mlx.invalidate();
+    ok = ok && (fabs(mlx.getEmissivity() - 0.9) < 0.0001) && !mlx.rwError;
+    mlx.setEmissivity(1.0);
+
+    // Sleep command (send byte with PEC), the device then ignores the bus.
+    ok = ok && mlx.sleep() && dev.asleep();
+    return ok;
+}
+
+int main(void) {
+    boolean ok = true;
+
+    printf("transport              ns/read   bus us/read   syscalls/read\n");
+
+    // Arduino style split transaction with the turnaround delay (a hand port makes a write() and
+    // a read() system call per read word).
+    {
+        MLX90614SimDevice dev;
+        MLX90614SimBus bus;
+        bus.attach(dev);
+        MLX90614 mlx(MLX90614_I2CDEFAULTADDR, &bus);
+        mlx.begin();
+        ok = run("split + XDLY", mlx, dev, NULL) && ok;
+    }
+
+    // I2C_RDWR combined transaction.
+    {
+        MLX90614SimDevice dev;
+        MLX90614SimBus bus;
+        bus.attach(dev);
+        MLX90614I2cFake sys(bus);
+        MLX90614LinuxBus i2c("/dev/i2c-1", false, sys.ops);
+        MLX90614 mlx(MLX90614_I2CDEFAULTADDR, &i2c);
+        mlx.begin();
+        ok = i2c.isOpen() && run("i2c-dev I2C_RDWR", mlx, dev, &sys.ioctls) && ok;
+    }
+
+    // SMBus word transfers with kernel PEC, adapter without I2C_RDWR.
+    {
+        MLX90614SimDevice dev;
+        MLX90614SimBus bus;
+        bus.attach(dev);
+        MLX90614I2cFake sys(bus, false);
+        MLX90614LinuxBus i2c("/dev/i2c-1", true, sys.ops);
+        MLX90614 mlx(MLX90614_I2CDEFAULTADDR, &i2c);
+        mlx.begin();
+        ok = i2c.isOpen() && run("i2c-dev SMBus PEC", mlx, dev, &sys.ioctls) && ok;
+    }
+
+    printf("\nself check %s\n", ok ? "passed" : "FAILED");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,105 @@
+/***********************************************************************************************//**
+ *  \brief      MLX90614 host benchmark - multi-sensor manager on one bus.
+ *  \par
+ *  \par        Details
+ *              Sixteen simulated devices share one 100kHz bus. A plain loop calling readTemp()
+ *              on each device in turn is compared with MLX90614Manager scheduling each device
+ *              at its data refresh period, and at a period shorter than the bus can sustain.
+ *              Each run lasts one second of simulated time.
+ *  \par        Build
+ *              See extras/README.md.
+ *
+ *  \file       BENCH_MANAGER.CPP
+ *  \author     J. F. Fitter <jfitter@eagleairaust.com.au>
+ *  \version    1.0
+ *  \date       2014-2017
+ *  \copyright  Copyright &copy; 2017 John Fitter.  All right reserved.
+ *
+ *  \par        License
+ *              This program is free software; you can redistribute it and/or modify it under
+ *              the terms of the GNU Lesser General Public License as published by the Free
+ *              Software Foundation; either version 2.1 of the License, or (at your option)
+ *              any later version.
+ *  \par
+ *              This Program is distributed in the hope that it will be useful, but WITHOUT ANY
+ *              WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *              PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details
+ *              at http://www.gnu.org/copyleft/gpl.html
+ *  \par
+ *              You should have received a copy of the GNU Lesser General Public License along
+ *              with this library; if not, write to the Free Software Foundation, Inc.,
+ *              51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *//***********************************************************************************************/
+
+#include <stdio.h>
+#include "MLX90614.h"
+#include "MLX90614Manager.h"
+#include "MLX90614Sim.h"
+
+#define NDEV        16
+#define RUNTIME     1000000UL
+#define RAW(i)      (0x3A00 + (i))  /**< Object temperature of device i */
+
+static MLX90614SimBus bus;
+static MLX90614SimDevice* dev[NDEV];
+static MLX90614* mlx[NDEV];
+
+/**
+ *  \brief  Run the manager for RUNTIME and print the results.
+ *  \return True if every device was added and sampled in turn with the expected value.
+ */
+static boolean runManager(const char* name, uint32_t period) {
+    MLX90614Manager mgr;
+    uint32_t worst = 0, tx0 = bus.transactions, sum = 0, lo = 0xFFFFFFFF, hi = 0;
+    boolean ok = true;
+
+    for(int i = 0; i < NDEV; i++) ok &= mgr.add(*mlx[i], MLX90614_TOBJ1, period);
+    mgr.resetStats();
+    uint32_t t0 = micros();
+    while((uint32_t)(micros() - t0) < RUNTIME) if(!mgr.poll()) hostAdvance(5);
+    for(int i = 0; i < NDEV; i++) {
+        // Finish the read still in flight, the device would refuse the next run's reads.
+        while(mlx[i]->poll() == MLX90614::MLX90614_PENDING) hostAdvance(5);
+        if(mgr.maxStaleness(i) > worst) worst = mgr.maxStaleness(i);
+        if(mgr.samples(i) < lo) lo = mgr.samples(i);
+        if(mgr.samples(i) > hi) hi = mgr.samples(i);
+        sum += mgr.samples(i);
+        ok &= !mgr.error(i) && (mgr.raw(i) == RAW(i));
+    }
+    ok &= (mgr.count() == NDEV) && lo && (hi - lo <= 1) && (sum == mgr.totalSamples());
+    printf("%-26s %8.1f samples/s   worst staleness %7.1f ms   %5u bus tx   %s\n",
+           name, mgr.sampleRate(), worst / 1000.0, bus.transactions - tx0, ok ? "ok" : "FAILED");
+    return ok;
+}
+
+int main(void) {
+    for(int i = 0; i < NDEV; i++) {
+        dev[i] = new MLX90614SimDevice(0x20 + i);
+        bus.attach(*dev[i]);
+        dev[i]->setRam(MLX90614_TOBJ1, RAW(i));
+        mlx[i] = new MLX90614(0x20 + i, &bus);
+        mlx[i]->begin();
+    }
+    printf("%d devices, data refresh period %u us\n", NDEV, mlx[0]->dataPeriod());
+
+    // Plain loop, every device read back to back.
+    uint32_t samples = 0, t0 = micros(), tx0 = bus.transactions, tl = 0, worst = 0;
+    while((uint32_t)(micros() - t0) < RUNTIME) {
+        uint32_t t = micros();
+        if(tl && (t - tl > worst)) worst = t - tl;
+        tl = t;
+        for(int i = 0; i < NDEV; i++) {
+            volatile double v = mlx[i]->readTemp();
+            (void)v;
+            ++samples;
+        }
+    }
+    printf("%-26s %8.1f samples/s   worst staleness %7.1f ms   %5u bus tx\n", "readTemp() loop",
+           samples * 1e6 / (micros() - t0), worst / 1000.0, bus.transactions - tx0);
+
+    // Round robin, every device sampled equally often with its own value.
+    boolean ok = runManager("manager, refresh period", 0);
+    ok &= runManager("manager, 5ms (saturated)", 5000);
+    return ok ? 0 : 1;
+}
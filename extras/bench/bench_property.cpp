@@ -0,0 +1,113 @@
+/***********************************************************************************************//**
+ *  \brief      MLX90614 host benchmark - Property versus StaticProperty.
+ *  \par
+ *  \par        Details
+ *              Compares the storage and access cost of the run time Property template (class
+ *              pointer and two member function pointers per property) with the compile time
+ *              StaticProperty now used by the device class. The sizes printed are host sizes,
+ *              the AVR sizes (2 byte pointers) are given alongside.
+ *  \par        Build
+ *              See extras/README.md.
+ *
+ *  \file       BENCH_PROPERTY.CPP
+ *  \author     J. F. Fitter <jfitter@eagleairaust.com.au>
+ *  \version    1.0
+ *  \date       2014-2017
+ *  \copyright  Copyright &copy; 2017 John Fitter.  All right reserved.
+ *
+ *  \par        License
+ *              This program is free software; you can redistribute it and/or modify it under
+ *              the terms of the GNU Lesser General Public License as published by the Free
+ *              Software Foundation; either version 2.1 of the License, or (at your option)
+ *              any later version.
+ *  \par
+ *              This Program is distributed in the hope that it will be useful, but WITHOUT ANY
+ *              WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *              PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details
+ *              at http://www.gnu.org/copyleft/gpl.html
+ *  \par
+ *              You should have received a copy of the GNU Lesser General Public License along
+ *              with this library; if not, write to the Free Software Foundation, Inc.,
+ *              51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *//***********************************************************************************************/
+
+#include <stdio.h>
+#include <chrono>
+#include "Property.h"
+#include "MLX90614.h"
+#include "MLX90614Sim.h"
+
+static volatile uint8_t sink;
+
+/** Four run time properties, as the device class had them. */
+class Dynamic {
+public:
+    Dynamic() : _a(1), _b(2) {
+        a.Set_Class(this); a.Set_Get(&Dynamic::getA); a.Set_Set(&Dynamic::setA);
+        b.Set_Class(this); b.Set_Get(&Dynamic::getB);
+        c.Set_Class(this); c.Set_Get(&Dynamic::getB);
+        d.Set_Class(this); d.Set_Get(&Dynamic::getB);
+    }
+    Property<uint8_t, Dynamic> a, b, c, d;
+private:
+    uint8_t _a, _b;
+    uint8_t getA(void)      {return _a;}
+    void    setA(uint8_t v) {_a = v;}
+    uint8_t getB(void)      {return _b;}
+};
+
+/** The same four properties at compile time. */
+class Static {
+    uint8_t getA(void)      {return _a;}
+    void    setA(uint8_t v) {_a = v;}
+    uint8_t getB(void)      {return _b;}
+public:
+    Static() : _a(1), _b(2) {}
+    union {
+        StaticProperty<uint8_t, Static, &Static::getA, &Static::setA> a;
+        StaticProperty<uint8_t, Static, &Static::getB> b, c, d;
+    };
+private:
+    uint8_t _a, _b;
+};
+
+template<typename T> static double cost(T& obj) {
+    const uint32_t N = 50000000;
+
+    auto t0 = std::chrono::steady_clock::now();
+    for(uint32_t i = 0; i < N; i++) {
+        obj.a = (uint8_t)i;
+        sink = obj.a + obj.b;
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(t1 - t0).count() / N;
+}
+
+int main(void) {
+    Dynamic dyn;
+    Static  sta;
+
+    // On AVR a Property is 2 member function pointers (4 bytes each, code address + this
+    // adjustment) and a 2 byte class pointer, 40 bytes for 4 properties. StaticProperty: 1 byte.
+    printf("                     host sizeof   ns per set+2 gets\n");
+    printf("4 x Property           %6zu        %8.2f\n", sizeof(dyn), cost(dyn));
+    printf("4 x StaticProperty     %6zu        %8.2f\n", sizeof(sta), cost(sta));
+    printf("MLX90614               %6zu\n", sizeof(MLX90614));
+    printf("MLX90614 with Property %6zu (estimated: +4 x %zu - 1)\n",
+           sizeof(MLX90614) + 4 * sizeof(Property<uint8_t, MLX90614>) - 1,
+           sizeof(Property<uint8_t, MLX90614>));
+
+    // Self check - the properties reach the right object.
+    MLX90614SimDevice dev;
+    MLX90614SimBus bus;
+    bus.attach(dev);
+    MLX90614 mlx[2] = {MLX90614(0x5A, &bus), MLX90614(0x5B, &bus)};
+    mlx[0].begin();
+    mlx[1].begin();
+    sink = mlx[0].readTemp() + mlx[1].readTemp();
+    boolean ok = !mlx[0].rwError && (mlx[0].crc8 == mlx[0].pec)
+              && (mlx[1].rwError & MLX90614_TXADDRNACK) && (dyn.a == sta.a);
+    printf("\nself check %s\n", ok ? "passed" : "FAILED");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,131 @@
+/***********************************************************************************************//**
+ *  \brief      MLX90614 host benchmark - PWM output decoder on synthetic waveforms.
+ *  \par
+ *  \par        Details
+ *              Generates single PWM mode edge streams for known temperatures with timestamp
+ *              quantization (4us, as micros() on a 16MHz AVR), jitter, glitches and missed
+ *              edges, then reports the decoding error for several averaging lengths and the host
+ *              cost per edge.
+ *  \par        Build
+ *              See extras/README.md.
+ *
+ *  \file       BENCH_PWM.CPP
+ *  \author     J. F. Fitter <jfitter@eagleairaust.com.au>
+ *  \version    1.0
+ *  \date       2014-2017
+ *  \copyright  Copyright &copy; 2017 John Fitter.  All right reserved.
+ *
+ *  \par        License
+ *              This program is free software; you can redistribute it and/or modify it under
+ *              the terms of the GNU Lesser General Public License as published by the Free
+ *              Software Foundation; either version 2.1 of the License, or (at your option)
+ *              any later version.
+ *  \par
+ *              This Program is distributed in the hope that it will be useful, but WITHOUT ANY
+ *              WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *              PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details
+ *              at http://www.gnu.org/copyleft/gpl.html
+ *  \par
+ *              You should have received a copy of the GNU Lesser General Public License along
+ *              with this library; if not, write to the Free Software Foundation, Inc.,
+ *              51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *//***********************************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <chrono>
+#include "MLX90614Pwm.h"
+
+#define PERIOD      1024.0      /**< PWM period (us) */
+#define TICK        4           /**< Timestamp resolution (us) */
+#define JITTER      2.0         /**< Edge jitter, +/- (us) */
+#define TMIN        -20.0       /**< Factory To_min (degC) */
+#define TMAX        120.0       /**< Factory To_max (degC) */
+
+/** Synthetic PWM edge stream. */
+struct Wave {
+    double   t;                 /**< Current time (us) */
+    uint32_t glitches;          /**< Glitches inserted */
+    uint32_t missed;            /**< Edges dropped */
+    double   pGlitch;           /**< Glitch probability per period */
+    double   pMiss;             /**< Missed edge probability */
+
+    static double rnd(void) {return (double)rand() / RAND_MAX;}
+    uint32_t stamp(double at) {return (uint32_t)(at + (rnd() * 2 - 1) * JITTER) / TICK * TICK;}
+
+    /** Emit one period for temperature degC, return the number of edges fed. */
+    uint32_t period(MLX90614Pwm& pwm, double degC, uint32_t& done) {
+        double thigh = PERIOD / 8 + (degC - TMIN) / (TMAX - TMIN) * PERIOD / 2;
+        uint32_t edges = 2;
+
+        if(rnd() >= pMiss) done += pwm.edge(stamp(t), true); else ++missed;
+        if(rnd() < pGlitch) {
+            double g = t + rnd() * thigh * 0.9;
+            done += pwm.edge(stamp(g), false);
+            done += pwm.edge(stamp(g + 3), true);
+            ++glitches;
+            edges += 2;
+        }
+        if(rnd() >= pMiss) done += pwm.edge(stamp(t + thigh), false); else ++missed;
+        t += PERIOD;
+        return edges;
+    }
+};
+
+/**
+ *  \brief  Decode n readings per temperature across the range.
+ *  \return RMS error (degC).
+ */
+static double run(uint8_t k, double pGlitch, double pMiss, uint32_t& rejected, double& ns) {
+    const int NT = 15, NR = 200;
+    MLX90614Pwm pwm(k);
+    Wave w = {0.0, 0, 0, pGlitch, pMiss};
+    double sq = 0;
+    uint32_t n = 0, edges = 0;
+
+    srand(1);
+    auto t0 = std::chrono::steady_clock::now();
+    for(int i = 0; i < NT; i++) {
+        double degC = TMIN + 0.5 + i * (TMAX - TMIN - 1) / (NT - 1);
+        pwm.reset();
+        for(uint32_t r = 0; r < (uint32_t)NR;) {
+            uint32_t done = 0;
+            edges += w.period(pwm, degC, done);
+            if(done) {
+                double e = pwm.readTemp() - degC;
+                sq += e * e;
+                ++n;
+                ++r;
+            }
+        }
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    ns = std::chrono::duration<double, std::nano>(t1 - t0).count() / edges;
+    rejected = pwm.rejected() + pwm.glitches();
+    return n ? sqrt(sq / n) : 1e9;
+}
+
+int main(void) {
+    uint32_t rej;
+    double ns, rms[3];
+    const uint8_t K[3] = {1, 4, 16};
+
+    printf("resolution %.3f degC per %dus tick, period %.0fus\n",
+           2 * TICK / PERIOD * (TMAX - TMIN), TICK, PERIOD);
+    printf("K    clean RMS   noisy RMS   glitches/rejected   host ns/edge\n");
+    for(int i = 0; i < 3; i++) {
+        double clean = run(K[i], 0.0, 0.0, rej, ns);
+        rms[i] = run(K[i], 0.01, 0.005, rej, ns);
+        printf("%-3u  %7.3f C   %7.3f C   %8u            %8.1f\n", K[i], clean, rms[i], rej, ns);
+    }
+
+    // Integer path agrees with the floating point one.
+    MLX90614Pwm pwm(1);
+    pwm.edge(0, true); pwm.edge(128 + 256, false); pwm.edge(1024, true); pwm.edge(1024 + 128, false);
+    int32_t fx = pwm.readTempFixed();
+    printf("fixed point check: %ld centi-degC (expect 5000)\n", (long)fx);
+
+    return (fx == 5000 && rms[2] < rms[0] && rms[2] < 0.25) ? 0 : 1;
+}
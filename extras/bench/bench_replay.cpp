@@ -0,0 +1,191 @@
+/***********************************************************************************************//**
+ *  \brief      MLX90614 host benchmark - bus recording and replay.
+ *  \par
+ *  \par        Details
+ *              Records a session (temperature reads with injected faults, an EEPROM write,
+ *              multi-channel reads) against the simulated device to a log file, replays the log
+ *              to a fresh driver and checks that every result and error is reproduced. Reports
+ *              the recording overhead and the replay speed.
+ *  \par        Build
+ *              See extras/README.md.
+ *
+ *  \file       BENCH_REPLAY.CPP
+ *  \author     J. F. Fitter <jfitter@eagleairaust.com.au>
+ *  \version    1.0
+ *  \date       2014-2017
+ *  \copyright  Copyright &copy; 2017 John Fitter.  All right reserved.
+ *
+ *  \par        License
+ *              This program is free software; you can redistribute it and/or modify it under
+ *              the terms of the GNU Lesser General Public License as published by the Free
+ *              Software Foundation; either version 2.1 of the License, or (at your option)
+ *              any later version.
+ *  \par
+ *              This Program is distributed in the hope that it will be useful, but WITHOUT ANY
+ *              WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *              PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details
+ *              at http://www.gnu.org/copyleft/gpl.html
+ *  \par
+ *              You should have received a copy of the GNU Lesser General Public License along
+ *              with this library; if not, write to the Free Software Foundation, Inc.,
+ *              51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *//***********************************************************************************************/
+
+#include <stdio.h>
+#include <chrono>
+#include <vector>
+#include "MLX90614Sim.h"
+#include "MLX90614Log.h"
+
+static const char* LOG = "bench_replay.log";
+static const uint32_t N = 50000;
+static uint32_t wakes;                      // sleep and wake up cycles that completed
+
+/**
+ *  Transport that checks the PEC itself, like the Linux SMBus PEC mode - every 50th read comes
+ *  back with MLX90614_RXCRC in the transport status.
+ */
+class PecStatusBus : public MLX90614Bus {
+public:
+    PecStatusBus(MLX90614Bus& bus) : flagged(0), _bus(&bus), _reads(0) {}
+    uint8_t  sendCommand(uint8_t addr, uint8_t cmd) {return _bus->sendCommand(addr, cmd);}
+    uint8_t  receive(uint8_t addr, uint8_t* buf, uint8_t len) {
+        uint8_t err = _bus->receive(addr, buf, len);
+        if(++_reads % 50 == 0) {
+            err |= MLX90614_RXCRC;
+            ++flagged;
+        }
+        return err;
+    }
+    uint8_t  transmit(uint8_t addr, const uint8_t* buf, uint8_t len) {return _bus->transmit(addr, buf, len);}
+    uint16_t turnaround(void) {return _bus->turnaround();}
+    boolean  wakeLine(boolean low) {return _bus->wakeLine(low);}
+    uint32_t flagged;
+private:
+    MLX90614Bus* _bus;
+    uint32_t _reads;
+};
+
+/** Result of one step of the session. */
+struct step_t {
+    int32_t  value;
+    uint8_t  err;
+    bool operator!=(const step_t& s) const {return (value != s.value) || (err != s.err);}
+};
+
+/**
+ *  \brief  The session - identical driver calls when recording and replaying.
+ *  \param  dev  Simulated device to inject faults into (recording only).
+ */
+static void session(MLX90614& mlx, MLX90614SimDevice* dev, std::vector<step_t>& out) {
+    MLX90614::snapshot_t snap;
+    out.clear();
+    for(uint32_t i = 0; i < N; i++) {
+        if(dev && (i % 97 == 0)) dev->injectFault(MLX90614SIM_BADPEC, 1);
+        if(dev && (i % 211 == 0)) dev->injectFault(MLX90614SIM_NACKADDR, 1);
+        if(dev && (i % 500 == 0)) dev->setTemp(MLX90614_TOBJ1, 300.0 + i / 500);
+        int32_t v = mlx.readTempFixed();
+        out.push_back({v, mlx.rwError});
+        if(i == N / 2) {
+            mlx.setEmissivity(0.9);
+            out.push_back({(int32_t)(mlx.getEmissivity() * 1000), mlx.rwError});
+        }
+        if(i % 10000 == 5000) {
+            // Sleep and wake up, waiting for the initialization.
+            boolean slept = mlx.sleep();
+            boolean woke = mlx.wake();
+            uint32_t polls = 0;
+            while(!mlx.initDone() && polls < 1000) {
+                ++polls;
+                delay(2);
+            }
+            if(slept && woke && (polls < 1000)) ++wakes;
+            out.push_back({(int32_t)polls, (uint8_t)(slept | woke << 1)});
+        }
+        if(i % 100 == 0) {
+            mlx.readAll(snap);
+            out.push_back({snap.raw[2] + snap.raw[4], snap.errMask});
+        }
+    }
+}
+
+int main(void) {
+    std::vector<step_t> rec, rep;
+
+    // Record.
+    MLX90614SimDevice dev;
+    MLX90614SimBus sim;
+    sim.attach(dev);
+    PecStatusBus pecBus(sim);
+    MLX90614FileSink file(LOG);
+    MLX90614Recorder recorder(pecBus, file);
+    MLX90614 mlx(MLX90614_I2CDEFAULTADDR, &recorder);
+    mlx.begin();
+    MLX90614::retry_t policy = mlx.getRetry();
+    policy.attempts = 2;
+    mlx.setRetry(policy);
+    wakes = 0;
+    auto t0 = std::chrono::steady_clock::now();
+    session(mlx, &dev, rec);
+    auto t1 = std::chrono::steady_clock::now();
+    uint32_t wakesRec = wakes;
+    file.close();
+    double nsRec = std::chrono::duration<double, std::nano>(t1 - t0).count() / recorder.records;
+
+    // Same session without recording, for the overhead.
+    MLX90614SimDevice dev2;
+    MLX90614SimBus sim2;
+    sim2.attach(dev2);
+    MLX90614 mlx2(MLX90614_I2CDEFAULTADDR, &sim2);
+    mlx2.begin();
+    std::vector<step_t> plain;
+    t0 = std::chrono::steady_clock::now();
+    session(mlx2, &dev2, plain);
+    t1 = std::chrono::steady_clock::now();
+    double nsSim = std::chrono::duration<double, std::nano>(t1 - t0).count() / sim2.transactions;
+
+    // Replay.
+    MLX90614ReplayBus replay;
+    boolean ok = replay.load(LOG);
+    MLX90614 mlx3(MLX90614_I2CDEFAULTADDR, &replay);
+    mlx3.begin();
+    mlx3.setRetry(policy);
+    wakes = 0;
+    t0 = std::chrono::steady_clock::now();
+    session(mlx3, NULL, rep);
+    t1 = std::chrono::steady_clock::now();
+    double nsRep = std::chrono::duration<double, std::nano>(t1 - t0).count() / replay.count();
+
+    uint32_t diff = 0;
+    for(size_t i = 0; i < rec.size() && i < rep.size(); i++) if(rec[i] != rep[i]) ++diff;
+
+    printf("records %u (%u bytes), %u steps\n", recorder.records,
+           recorder.records * MLX90614_BUSRECLEN + MLX90614LOG_HEADERLEN, (uint32_t)rec.size());
+    printf("simulated bus        %8.1f ns/transaction (host)\n", nsSim);
+    printf("simulated + record   %8.1f ns/transaction (host)\n", nsRec);
+    printf("replay               %8.1f ns/transaction (host)\n", nsRep);
+    printf("replay: %u mismatched transactions, %u differing steps (values, errors)\n",
+           replay.mismatches, diff);
+    printf("sleep / wake up: %u recorded, %u replayed\n", wakesRec, wakes);
+    printf("transport PEC errors recorded: %u\n", pecBus.flagged);
+
+    // A read whose data is fetched from another address than the command went to.
+    uint8_t raw[MLX90614LOG_HEADERLEN + MLX90614_BUSRECLEN], data[3];
+    MLX90614BusRecord first;
+    FILE* f = fopen(LOG, "rb");
+    boolean okAddr = f && (fread(raw, 1, sizeof(raw), f) == sizeof(raw));
+    if(f) fclose(f);
+    first.unpack(raw + MLX90614LOG_HEADERLEN);
+    MLX90614ReplayBus wrong;
+    okAddr = okAddr && wrong.load(LOG) && (first.kind == MLX90614_RECREAD);
+    if(okAddr) wrong.sendCommand(first.addr, first.cmd);
+    okAddr = okAddr && !wrong.mismatches && (wrong.receive(first.addr + 1, data, 3) == MLX90614_TXOTHER) && (wrong.mismatches == 1);
+    printf("read from the wrong address: %s\n", okAddr ? "mismatch" : "NOT DETECTED");
+
+    remove(LOG);
+    ok = okAddr && ok && replay.done() && !replay.mismatches && !diff && (rec.size() == rep.size())
+         && (wakesRec == N / 10000) && (wakes == wakesRec);
+    printf("\nself check %s\n", ok ? "passed" : "FAILED");
+    return ok ? 0 : 1;
+}
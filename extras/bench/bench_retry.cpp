@@ -0,0 +1,118 @@
+/***********************************************************************************************//**
+ *  \brief      MLX90614 host benchmark - automatic read retry policy.
+ *  \par
+ *  \par        Details
+ *              Reads through a noisy bus (random PEC errors and NACKs) with and without retries
+ *              and reports lost samples, attempts and bus time per good sample. A dead device
+ *              shows the deadline bounding the time spent retrying.
+ *  \par        Build
+ *              See extras/README.md.
+ *
+ *  \file       BENCH_RETRY.CPP
+ *  \author     J. F. Fitter <jfitter@eagleairaust.com.au>
+ *  \version    1.0
+ *  \date       2014-2017
+ *  \copyright  Copyright &copy; 2017 John Fitter.  All right reserved.
+ *
+ *  \par        License
+ *              This program is free software; you can redistribute it and/or modify it under
+ *              the terms of the GNU Lesser General Public License as published by the Free
+ *              Software Foundation; either version 2.1 of the License, or (at your option)
+ *              any later version.
+ *  \par
+ *              This Program is distributed in the hope that it will be useful, but WITHOUT ANY
+ *              WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *              PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details
+ *              at http://www.gnu.org/copyleft/gpl.html
+ *  \par
+ *              You should have received a copy of the GNU Lesser General Public License along
+ *              with this library; if not, write to the Free Software Foundation, Inc.,
+ *              51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *//***********************************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "MLX90614.h"
+#include "MLX90614Sim.h"
+
+static volatile double sink;
+
+/**
+ *  \brief  Read N samples with a fault injected before a fraction of the transactions.
+ *  \return Samples lost (read returned an error).
+ */
+static uint32_t run(MLX90614& mlx, MLX90614SimDevice& dev, uint32_t n, uint32_t& attempts,
+                    uint32_t& us) {
+    uint32_t lost = 0;
+
+    srand(1);
+    attempts = 0;
+    uint32_t t0 = micros();
+    for(uint32_t i = 0; i < n; i++) {
+        int r = rand() % 100;
+        if(r < 5) dev.injectFault(MLX90614SIM_BADPEC, 1);          // 5% PEC errors
+        else if(r < 7) dev.injectFault(MLX90614SIM_NACKADDR, 1);   // 2% address NACKs
+        sink = mlx.readTemp();
+        attempts += mlx.attempts();
+        if(mlx.rwError) ++lost;
+    }
+    us = micros() - t0;
+    return lost;
+}
+
+int main(void) {
+    const uint32_t N = 100000;
+    MLX90614SimDevice dev;
+    MLX90614SimBus bus;
+    bus.attach(dev);
+    MLX90614 mlx(MLX90614_I2CDEFAULTADDR, &bus);
+    mlx.begin();
+
+    uint32_t att, us;
+    printf("policy                 lost    attempts/read  bus us/good sample\n");
+
+    uint32_t lost1 = run(mlx, dev, N, att, us);
+    printf("1 attempt (default)  %6u    %8.3f        %8.1f\n", lost1, (double)att / N,
+           (double)us / (N - lost1));
+
+    MLX90614::retry_t policy = mlx.getRetry();
+    policy.attempts = 3;
+    policy.backoff = 50;
+    mlx.setRetry(policy);
+    uint32_t lost3 = run(mlx, dev, N, att, us);
+    printf("3 attempts, 50us     %6u    %8.3f        %8.1f\n", lost3, (double)att / N,
+           (double)us / (N - lost3));
+
+    // Multi-channel read, each channel retried.
+    MLX90614::snapshot_t snap;
+    dev.injectFault(MLX90614SIM_BADPEC, 2);
+    uint8_t err = mlx.readAll(snap, MLX90614_CHTA | MLX90614_CHTOBJ1 | MLX90614_CHTOBJ2);
+    printf("readAll (3 ch), 2 PEC errors: errors 0x%02X, %u attempts\n", err, mlx.attempts());
+    boolean okAll = !err && (mlx.attempts() == 5);
+
+    // Dead device, the deadline bounds the time spent.
+    policy.attempts = 255;
+    policy.backoff = 200;
+    policy.deadline = 5000;
+    mlx.setRetry(policy);
+    dev.injectFault(MLX90614SIM_NACKADDR, 1000);
+    uint32_t t0 = micros();
+    sink = mlx.readTemp();
+    uint32_t dt = micros() - t0;
+    printf("dead device, 5000us deadline: %u attempts in %u us, errors 0x%02X\n",
+           mlx.attempts(), dt, (uint8_t)mlx.rwError);
+
+    // Dead device, no deadline, 5 channels of 255 attempts - the total saturates.
+    policy.deadline = 0;
+    policy.backoff = 0;
+    mlx.setRetry(policy);
+    dev.injectFault(MLX90614SIM_NACKADDR, 5 * 255);
+    err = mlx.readAll(snap);
+    printf("dead device, readAll (5 ch) of 255 attempts: %u attempts reported\n", mlx.attempts());
+    okAll = okAll && err && (mlx.attempts() == 255);
+
+    boolean ok = okAll && (lost3 < lost1 / 100) && (dt <= 5000) && mlx.rwError;
+    printf("\nself check %s\n", ok ? "passed" : "FAILED");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,122 @@
+/***********************************************************************************************//**
+ *  \brief      MLX90614 host benchmark - duty cycled sampling with sleep mode.
+ *  \par
+ *  \par        Details
+ *              Samples a simulated device once per second, sleeping in between. Compares waiting
+ *              for the INIT flag after wake up with a fixed worst case wait and with a device that
+ *              is never put to sleep, and estimates the average supply current from the data
+ *              sheet typical figures.
+ *  \par        Build
+ *              See extras/README.md.
+ *
+ *  \file       BENCH_SLEEP.CPP
+ *  \author     J. F. Fitter <jfitter@eagleairaust.com.au>
+ *  \version    1.0
+ *  \date       2014-2017
+ *  \copyright  Copyright &copy; 2017 John Fitter.  All right reserved.
+ *
+ *  \par        License
+ *              This program is free software; you can redistribute it and/or modify it under
+ *              the terms of the GNU Lesser General Public License as published by the Free
+ *              Software Foundation; either version 2.1 of the License, or (at your option)
+ *              any later version.
+ *  \par
+ *              This Program is distributed in the hope that it will be useful, but WITHOUT ANY
+ *              WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *              PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details
+ *              at http://www.gnu.org/copyleft/gpl.html
+ *  \par
+ *              You should have received a copy of the GNU Lesser General Public License along
+ *              with this library; if not, write to the Free Software Foundation, Inc.,
+ *              51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *//***********************************************************************************************/
+
+#include <stdio.h>
+#include "MLX90614.h"
+#include "MLX90614DutyCycle.h"
+#include "MLX90614Sim.h"
+
+#define IACTIVE     1.3         /**< Typical supply current, awake (mA) */
+#define ISLEEP      0.0025      /**< Typical supply current, sleep mode (mA) */
+#define PERIOD      1000000UL   /**< Sampling period (us) */
+#define LOOPTIME    100         /**< Main loop iteration time (us) */
+
+/** Average supply current (mA) for a fraction of time awake. */
+static double current(double duty) {return duty * IACTIVE + (1.0 - duty) * ISLEEP;}
+
+int main(void) {
+    const uint32_t N = 100;
+    const uint16_t RAW = 0x3AF7;
+    uint32_t bad = 0;
+
+    MLX90614SimDevice dev;
+    MLX90614SimBus bus;
+    bus.attach(dev);
+    dev.setRam(MLX90614_TOBJ1, RAW);
+    MLX90614 mlx(MLX90614_I2CDEFAULTADDR, &bus);
+    mlx.begin();
+
+    // Non-blocking scheduler, wake up ends at the INIT flag.
+    MLX90614DutyCycle dc(mlx, PERIOD);
+    uint32_t lat = 0, polls = 0, t0 = micros();
+    while(dc.cycles() < N) {
+        if(dc.poll() == MLX90614::MLX90614_DONE) {
+            if(dc.error() || dc.raw() != RAW) ++bad;
+            lat += dc.wakeLatency();
+            polls += dc.flagPolls();
+        }
+        hostAdvance(LOOPTIME);
+    }
+    double duty = dc.dutyCycle();
+    double elapsed = (micros() - t0) / 1e6;
+    printf("mode              awake/cycle   duty      current    samples  bad\n");
+    printf("INIT flag poll    %8.1f ms  %6.2f%%  %8.4f mA  %6u  %4u   (wake %.1f ms, %.1f flag reads)\n",
+           elapsed * duty * 1000 / N, duty * 100, current(duty), N, bad,
+           (double)lat / (N - 1) / 1000, (double)polls / (N - 1));
+
+    // The flags register fails for a whole wake up. That cycle falls back to the worst case wait,
+    // the next wake up polls the INIT flag again.
+    uint32_t c = dc.cycles();
+    dev.injectFault(MLX90614SIM_NACKADDR, 100000);
+    while(dc.cycles() == c) {dc.poll(); hostAdvance(LOOPTIME);}
+    dev.injectFault(MLX90614SIM_NOFAULT, 0);
+    uint32_t rPolls = 0;
+    while(dc.cycles() < c + 3) {
+        if(dc.poll() == MLX90614::MLX90614_DONE) rPolls = dc.flagPolls();
+        hostAdvance(LOOPTIME);
+    }
+    boolean recOk = !dc.error() && rPolls && dc.wakeLatency() < MLX90614_TWAKELOW + MLX90614_TINITMAX;
+
+    // Blocking baseline, fixed worst case wait after wake up.
+    MLX90614::snapshot_t snap;
+    uint32_t awake = 0, fbad = 0;
+    t0 = micros();
+    for(uint32_t i = 0; i < N; i++) {
+        uint32_t start = micros();
+        mlx.wake();
+        delayMicroseconds(MLX90614_TINITMAX);
+        if(mlx.readAll(snap, MLX90614_CHTOBJ1) || snap.raw[3] != RAW) ++fbad;
+        mlx.sleep();
+        awake += micros() - start;
+        delayMicroseconds(PERIOD - (micros() - start));
+    }
+    double fduty = (double)awake / (micros() - t0);
+    printf("fixed wait        %8.1f ms  %6.2f%%  %8.4f mA  %6u  %4u\n",
+           (double)awake / N / 1000, fduty * 100, current(fduty), N, fbad);
+
+    // Never asleep.
+    printf("always awake      %8.1f ms  %6.2f%%  %8.4f mA\n", PERIOD / 1000.0, 100.0, current(1.0));
+    printf("sleep commands %u, time asleep %.1f s\n", dev.sleeps, dev.sleepTime / 1e6);
+
+    // A register outside the RAM temperatures (eg. the EEPROM ID word) is refused without any bus
+    // traffic.
+    uint32_t tx = bus.transactions;
+    MLX90614DutyCycle inv(mlx, PERIOD, MLX90614_ID1);
+    boolean invOk = (inv.poll() == MLX90614::MLX90614_IDLE) && (inv.error() == MLX90614_INVALIDATA)
+                 && (bus.transactions == tx) && (inv.dutyCycle() == 1.0);
+    printf("invalid register  %s\n", invOk ? "refused" : "NOT REFUSED");
+    printf("flags recovery    %s\n", recOk ? "polled again" : "NOT RECOVERED");
+
+    return (!bad && !fbad && duty < fduty && dev.sleeps == 2 * N + 2 && invOk && recOk) ? 0 : 1;
+}
@@ -0,0 +1,112 @@
+/***********************************************************************************************//**
+ *  \brief      MLX90614 host benchmark - compile time specialized reader.
+ *  \par
+ *  \par        Details
+ *              Compares MLX90614Static<Addr, Src, Unit> with the run time MLX90614 class reading
+ *              the same register through the same simulated bus: object size, host cost per
+ *              read and identical results.
+ *  \par        Build
+ *              See extras/README.md.
+ *
+ *  \file       BENCH_STATIC.CPP
+ *  \author     J. F. Fitter <jfitter@eagleairaust.com.au>
+ *  \version    1.0
+ *  \date       2014-2017
+ *  \copyright  Copyright &copy; 2017 John Fitter.  All right reserved.
+ *
+ *  \par        License
+ *              This program is free software; you can redistribute it and/or modify it under
+ *              the terms of the GNU Lesser General Public License as published by the Free
+ *              Software Foundation; either version 2.1 of the License, or (at your option)
+ *              any later version.
+ *  \par
+ *              This Program is distributed in the hope that it will be useful, but WITHOUT ANY
+ *              WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *              PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details
+ *              at http://www.gnu.org/copyleft/gpl.html
+ *  \par
+ *              You should have received a copy of the GNU Lesser General Public License along
+ *              with this library; if not, write to the Free Software Foundation, Inc.,
+ *              51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *//***********************************************************************************************/
+
+#include <stdio.h>
+#include <chrono>
+#include "MLX90614Static.h"
+#include "MLX90614Sim.h"
+
+static volatile int32_t sink;
+
+typedef MLX90614Static<0x5A, MLX90614::MLX90614_SRC01, MLX90614::MLX90614_TF> StaticF;
+
+// Command and conversion are compile time constants.
+static_assert(MLX90614Static<0x5A, MLX90614::MLX90614_SRCA>::cmd == MLX90614_TA, "command");
+static_assert(StaticF::toFixed(15515) == 9887, "310.30K = 98.87F");
+
+/** Transport that replays one valid response, so only the driver side is timed. */
+class FixedBus : public MLX90614Bus {
+public:
+    uint8_t  sendCommand(uint8_t, uint8_t) {return MLX90614_NORWERROR;}
+    uint8_t  transmit(uint8_t, const uint8_t*, uint8_t) {return MLX90614_NORWERROR;}
+    uint8_t  receive(uint8_t, uint8_t* buf, uint8_t len) {
+        memcpy(buf, resp, len);
+        return MLX90614_NORWERROR;
+    }
+    uint8_t  resp[3];
+};
+
+template<typename Fn> static double cost(uint32_t n, Fn fn) {
+    auto t0 = std::chrono::steady_clock::now();
+    for(uint32_t i = 0; i < n; i++) fn();
+    auto t1 = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(t1 - t0).count() / n;
+}
+
+int main(void) {
+    const uint32_t N = 500000;
+    MLX90614SimDevice dev;
+    MLX90614SimBus bus(0);                                  // Transactions take no bus time
+    bus.setTurnaround(0);
+    bus.attach(dev);
+    MLX90614 mlx(0x5A, &bus);
+    StaticF  fix(&bus);
+    mlx.begin();
+
+    FixedBus fbus;
+    fbus.resp[0] = 0x9b;
+    fbus.resp[1] = 0x3c;
+    CRC8 pec(MLX90614_CRC8POLY, StaticF::prefix);
+    pec.crc8(fbus.resp[0]);
+    fbus.resp[2] = pec.crc8(fbus.resp[1]);
+    MLX90614 mlxF(0x5A, &fbus);
+    StaticF  fixF(&fbus);
+    mlxF.begin();
+
+    double simDyn = cost(N, [&]() {sink = mlx.readTempFixed(MLX90614::MLX90614_SRC01, MLX90614::MLX90614_TF);});
+    double simSta = cost(N, [&]() {sink = fix.readTempFixed();});
+    double fixDyn = cost(N, [&]() {sink = mlxF.readTempFixed(MLX90614::MLX90614_SRC01, MLX90614::MLX90614_TF);});
+    double fixSta = cost(N, [&]() {sink = fixF.readTempFixed();});
+    printf("                   sizeof   ns/readTempFixed (simulated bus)   (fixed response bus)\n");
+    printf("MLX90614           %6zu   %8.1f                           %8.1f\n", sizeof(mlx), simDyn, fixDyn);
+    printf("MLX90614Static     %6zu   %8.1f                           %8.1f\n", sizeof(fix), simSta, fixSta);
+    boolean ok = !mlxF.rwError && !fixF.rwError;
+
+    // Self check - same PEC header, same results, same fault detection.
+    CRC8 crc(MLX90614_CRC8POLY);
+    crc.crc8(0x5A << 1);
+    crc.crc8(MLX90614_TOBJ1);
+    ok = ok && (crc.crc8((0x5A << 1) + 1) == StaticF::prefix);
+    for(uint16_t raw = 0; raw < 0x8000; raw += 7) {
+        dev.setRam(MLX90614_TOBJ1, raw);
+        int32_t a = mlx.readTempFixed(MLX90614::MLX90614_SRC01, MLX90614::MLX90614_TF);
+        int32_t b = fix.readTempFixed();
+        if((a != b) || mlx.rwError || fix.rwError) ok = false;
+        if(mlx.readTemp(MLX90614::MLX90614_SRC01, MLX90614::MLX90614_TF) != fix.readTemp()) ok = false;
+    }
+    dev.injectFault(MLX90614SIM_BADPEC, 1);
+    sink = fix.readRaw();
+    ok = ok && (fix.rwError == MLX90614_RXCRC);
+    printf("\nself check %s\n", ok ? "passed" : "FAILED");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,100 @@
+/***********************************************************************************************//**
+ *  \brief      MLX90614 host benchmark - transaction statistics.
+ *  \par
+ *  \par        Details
+ *              Built against the library with MLX90614_STATS = 1. Runs a mixed workload with
+ *              injected faults, prints the statistics snapshot and the host cost per readTemp()
+ *              with the statistics compiled in (compare with bench_transport).
+ *  \par        Build
+ *              See extras/README.md.
+ *
+ *  \file       BENCH_STATS.CPP
+ *  \author     J. F. Fitter <jfitter@eagleairaust.com.au>
+ *  \version    1.0
+ *  \date       2014-2017
+ *  \copyright  Copyright &copy; 2017 John Fitter.  All right reserved.
+ *
+ *  \par        License
+ *              This program is free software; you can redistribute it and/or modify it under
+ *              the terms of the GNU Lesser General Public License as published by the Free
+ *              Software Foundation; either version 2.1 of the License, or (at your option)
+ *              any later version.
+ *  \par
+ *              This Program is distributed in the hope that it will be useful, but WITHOUT ANY
+ *              WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *              PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details
+ *              at http://www.gnu.org/copyleft/gpl.html
+ *  \par
+ *              You should have received a copy of the GNU Lesser General Public License along
+ *              with this library; if not, write to the Free Software Foundation, Inc.,
+ *              51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *//***********************************************************************************************/
+
+#include <stdio.h>
+#include <chrono>
+#include "MLX90614.h"
+#include "MLX90614Sim.h"
+
+#if !MLX90614_STATS
+#error "bench_stats must be built with MLX90614_STATS=1"
+#endif
+
+static volatile double sink;
+
+int main(void) {
+    const uint32_t N = 200000;
+    MLX90614SimDevice dev;
+    MLX90614SimBus bus;
+    bus.attach(dev);
+    MLX90614 mlx(MLX90614_I2CDEFAULTADDR, &bus);
+    mlx.begin();
+    mlx.resetStats();
+
+    // Host CPU cost per readTemp() with the statistics compiled in.
+    auto t0 = std::chrono::steady_clock::now();
+    for(uint32_t i = 0; i < N; i++) sink = mlx.readTemp();
+    auto t1 = std::chrono::steady_clock::now();
+    double ns = std::chrono::duration<double, std::nano>(t1 - t0).count() / N;
+    printf("readTemp        %8.1f ns/op (host, MLX90614_STATS=1)\n", ns);
+
+    // Mixed workload with faults.
+    const uint32_t NF = 1000;
+    dev.injectFault(MLX90614SIM_BADPEC, NF);
+    for(uint32_t i = 0; i < NF; i++) sink = mlx.readTemp();
+    dev.injectFault(MLX90614SIM_NACKADDR, NF);
+    for(uint32_t i = 0; i < NF; i++) sink = mlx.readTemp(MLX90614::MLX90614_SRCA);
+    sink = mlx.getEmissivity();
+    mlx.setEmissivity(0.95);
+
+    MLX90614::stats_t st;
+    mlx.stats(st);
+
+    printf("\nTransactions per command\n");
+    for(uint8_t i = 0; i < MLX90614_STATCMDS; i++) {
+        if(!st.tx[i]) continue;
+        if(i < 5)       printf("  RAM    0x%02X  %8u\n", MLX90614_RAWIR1 + i, st.tx[i]);
+        else if(i < 37) printf("  EEPROM 0x%02X  %8u\n", 0x20 + i - 5, st.tx[i]);
+        else if(i < 38) printf("  flags  0xF0  %8u\n", st.tx[i]);
+        else            printf("  other        %8u\n", st.tx[i]);
+    }
+    printf("Errors per flag bit\n");
+    for(uint8_t i = 0; i < 8; i++) if(st.errors[i]) printf("  0x%02X  %8u\n", 1 << i, st.errors[i]);
+    printf("Latency histogram\n");
+    for(uint8_t i = 0; i < MLX90614_STATBUCKETS; i++)
+        if(st.latency[i]) printf("  %6u...%6u us  %8u\n", i ? 1U << i : 0, (2U << i) - 1, st.latency[i]);
+
+    // Self check - every transaction is counted once and every injected fault is seen (a NACKed
+    // command is followed by a read of an idle bus, so it is also counted as a PEC error).
+    uint32_t ntx = 0, nlat = 0;
+    for(uint8_t i = 0; i < MLX90614_STATCMDS; i++) ntx += st.tx[i];
+    for(uint8_t i = 0; i < MLX90614_STATBUCKETS; i++) nlat += st.latency[i];
+    boolean ok = (ntx == nlat) && (ntx >= N + 2 * NF)
+              && (st.errors[4] == 2 * NF)                  // MLX90614_RXCRC
+              && (st.errors[1] == NF);                     // MLX90614_TXADDRNACK
+    mlx.resetStats();
+    mlx.stats(st);
+    ok = ok && !st.tx[MLX90614_TOBJ1 - MLX90614_RAWIR1];
+    printf("\nself check %s\n", ok ? "passed" : "FAILED");
+    return ok ? 0 : 1;
+}
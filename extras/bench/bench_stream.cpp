@@ -0,0 +1,104 @@
+/***********************************************************************************************//**
+ *  \brief      MLX90614 host benchmark - streaming acquisition into the sample ring buffer.
+ *  \par
+ *  \par        Details
+ *              A simulated 100Hz timer ticks an MLX90614Stream reading Ta and Tobj1, while a
+ *              consumer drains the ring in batches. With a prompt consumer nothing is lost; with
+ *              a consumer slower than the ring can cover, overruns are counted. A tick rate
+ *              faster than the bus can serve is counted as drops. Each run lasts ten seconds
+ *              of simulated time.
+ *  \par        Build
+ *              See extras/README.md.
+ *
+ *  \file       BENCH_STREAM.CPP
+ *  \author     J. F. Fitter <jfitter@eagleairaust.com.au>
+ *  \version    1.0
+ *  \date       2014-2017
+ *  \copyright  Copyright &copy; 2017 John Fitter.  All right reserved.
+ *
+ *  \par        License
+ *              This program is free software; you can redistribute it and/or modify it under
+ *              the terms of the GNU Lesser General Public License as published by the Free
+ *              Software Foundation; either version 2.1 of the License, or (at your option)
+ *              any later version.
+ *  \par
+ *              This Program is distributed in the hope that it will be useful, but WITHOUT ANY
+ *              WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *              PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details
+ *              at http://www.gnu.org/copyleft/gpl.html
+ *  \par
+ *              You should have received a copy of the GNU Lesser General Public License along
+ *              with this library; if not, write to the Free Software Foundation, Inc.,
+ *              51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *//***********************************************************************************************/
+
+#include <stdio.h>
+#include <chrono>
+#include "MLX90614.h"
+#include "MLX90614Stream.h"
+#include "MLX90614Sim.h"
+
+#define RUNTIME     10000000UL
+
+/**
+ *  \brief              Run a stream and print the counters.
+ *  \param [in] tickUs  Tick period (us).
+ *  \param [in] drainUs Consumer drain period (us).
+ */
+static void run(MLX90614& mlx, uint32_t tickUs, uint32_t drainUs) {
+    MLX90614Stream<32> stream(mlx, MLX90614_CHTA | MLX90614_CHTOBJ1);
+    MLX90614Record batch[32];
+    uint32_t consumed = 0, ticks = 0, batches = 0, bad = 0, lastStamp = 0;
+    uint32_t t0 = micros(), nextTick = t0, nextDrain = t0 + drainUs;
+
+    auto c0 = std::chrono::steady_clock::now();
+    while((uint32_t)(micros() - t0) < RUNTIME) {
+        uint32_t now = micros();
+        if((int32_t)(now - nextTick) >= 0) {
+            stream.tick();
+            ++ticks;
+            nextTick += tickUs;
+        }
+        if((int32_t)(now - nextDrain) >= 0) {
+            uint8_t n = stream.drain(batch, 32);
+            for(uint8_t i = 0; i < n; i++) {
+                if(batch[i].flags || (batch[i].timestamp < lastStamp)) ++bad;
+                lastStamp = batch[i].timestamp;
+            }
+            consumed += n;
+            ++batches;
+            nextDrain += drainUs;
+        }
+        if(!stream.service()) hostAdvance(10);
+    }
+    auto c1 = std::chrono::steady_clock::now();
+    printf("tick %5u us  drain %6u us   %5u ticks  %5u records  %5u batches  "
+           "%4u overruns  %4u drops  %u bad   %.0f ns host/record\n",
+           tickUs, drainUs, ticks, consumed, batches, stream.overruns, stream.drops(), bad,
+           std::chrono::duration<double, std::nano>(c1 - c0).count() / (consumed ? consumed : 1));
+}
+
+int main(void) {
+    MLX90614SimDevice dev;
+    MLX90614SimBus bus;
+    bus.attach(dev);
+    MLX90614 mlx(MLX90614_I2CDEFAULTADDR, &bus);
+    mlx.begin();
+
+    run(mlx, 10000, 100000);
+    run(mlx, 10000, 500000);
+    run(mlx, 1000, 10000);
+
+    // A tick served while the device is busy with another asynchronous read.
+    MLX90614Stream<8> stream(mlx, MLX90614_CHTA | MLX90614_CHTOBJ1);
+    MLX90614Record rec;
+    mlx.startReadRaw(MLX90614_TOBJ2);
+    stream.tick();
+    uint8_t n = stream.service();
+    uint8_t flagged = 0;
+    while(stream.pop(rec)) if(rec.flags == MLX90614_INVALIDATA) ++flagged;
+    while(mlx.poll() == MLX90614::MLX90614_PENDING) hostAdvance(10);
+    printf("device busy: %u records, %u flagged MLX90614_INVALIDATA\n", n, flagged);
+    return (n == 2) && (flagged == 2) ? 0 : 1;
+}
@@ -0,0 +1,123 @@
+/***********************************************************************************************//**
+ *  \brief      MLX90614 host benchmark suite - driver hot paths.
+ *  \par
+ *  \par        Details
+ *              Measures the driver hot paths against the simulated bus and prints, for each,
+ *              the host CPU time per operation, the simulated bus time per operation and the
+ *              bus transactions per second. The same results are written as JSON to the file
+ *              named on the command line (default bench_results.json) so that releases can be
+ *              compared.
+ *  \par        Build
+ *              See extras/README.md.
+ *
+ *  \file       BENCH_SUITE.CPP
+ *  \author     J. F. Fitter <jfitter@eagleairaust.com.au>
+ *  \version    1.0
+ *  \date       2014-2017
+ *  \copyright  Copyright &copy; 2017 John Fitter.  All right reserved.
+ *
+ *  \par        License
+ *              This program is free software; you can redistribute it and/or modify it under
+ *              the terms of the GNU Lesser General Public License as published by the Free
+ *              Software Foundation; either version 2.1 of the License, or (at your option)
+ *              any later version.
+ *  \par
+ *              This Program is distributed in the hope that it will be useful, but WITHOUT ANY
+ *              WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *              PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details
+ *              at http://www.gnu.org/copyleft/gpl.html
+ *  \par
+ *              You should have received a copy of the GNU Lesser General Public License along
+ *              with this library; if not, write to the Free Software Foundation, Inc.,
+ *              51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *//***********************************************************************************************/
+
+#include <stdio.h>
+#include <chrono>
+#include "MLX90614.h"
+#include "MLX90614Sim.h"
+
+/** One benchmark result. */
+struct result_t {
+    const char* name;
+    uint32_t ops;
+    double   ns;                                            /**< Host time per operation */
+    double   busUs;                                         /**< Simulated bus time per operation */
+    double   txps;                                          /**< Bus transactions per second */
+};
+
+static MLX90614SimDevice dev;
+static MLX90614SimBus bus;
+static result_t results[32];
+static int nresults = 0;
+static volatile uint32_t sink;
+
+/**
+ *  \brief              Time n calls of fn.
+ *  \param [in] name    Benchmark name.
+ *  \param [in] n       Number of operations.
+ *  \param [in] fn      Operation.
+ */
+template<typename Fn> static void measure(const char* name, uint32_t n, Fn fn) {
+    for(uint32_t i = 0; i < n / 100 + 1; i++) fn(i);
+
+    uint32_t tx0 = bus.transactions, v0 = micros();
+    auto t0 = std::chrono::steady_clock::now();
+    for(uint32_t i = 0; i < n; i++) fn(i);
+    auto t1 = std::chrono::steady_clock::now();
+    uint32_t tx = bus.transactions - tx0, vus = micros() - v0;
+
+    result_t& r = results[nresults++];
+    r.name = name;
+    r.ops = n;
+    r.ns = std::chrono::duration<double, std::nano>(t1 - t0).count() / n;
+    r.busUs = (double)vus / n;
+    r.txps = vus ? tx * 1e6 / vus : 0;
+    printf("%-28s %10.2f ns/op %10.1f us/op (bus) %10.1f tx/s\n", r.name, r.ns, r.busUs, r.txps);
+}
+
+int main(int argc, char** argv) {
+    const char* path = argc > 1 ? argv[1] : "bench_results.json";
+    static uint8_t buf[1024];
+
+    bus.attach(dev);
+    MLX90614 mlx(MLX90614_I2CDEFAULTADDR, &bus);
+    mlx.begin();
+    for(size_t i = 0; i < sizeof(buf); i++) buf[i] = i * 37;
+
+    measure("crc8 per byte", 4000000, [&](uint32_t i) {
+        static CRC8 crc;
+        sink = crc.crc8(buf[i & 1023]);
+    });
+    measure("crc8 bulk 1024 bytes", 20000, [&](uint32_t) {
+        CRC8 crc;
+        sink = crc.crc8(buf, sizeof(buf));
+    });
+    measure("read16 (readEEProm)", 200000, [&](uint32_t) {sink = mlx.readEEProm(MLX90614_CONFIG);});
+    measure("readTemp K", 200000, [&](uint32_t) {sink = mlx.readTemp(MLX90614::MLX90614_SRC01, MLX90614::MLX90614_TK);});
+    measure("readTemp C", 200000, [&](uint32_t) {sink = mlx.readTemp(MLX90614::MLX90614_SRC01, MLX90614::MLX90614_TC);});
+    measure("readTemp F", 200000, [&](uint32_t) {sink = mlx.readTemp(MLX90614::MLX90614_SRC01, MLX90614::MLX90614_TF);});
+    measure("readID", 50000, [&](uint32_t) {sink = mlx.readID();});
+    measure("writeEEProm unchanged", 200000, [&](uint32_t) {mlx.writeEEProm(MLX90614_EMISS, 0xF000);});
+    measure("writeEEProm changed", 2000, [&](uint32_t i) {mlx.writeEEProm(MLX90614_EMISS, 0xF000 + (i & 1));});
+    measure("property get rwError", 10000000, [&](uint32_t) {sink = mlx.rwError;});
+    measure("property get crc8+pec", 10000000, [&](uint32_t) {sink = mlx.crc8 + mlx.pec;});
+
+    FILE* f = fopen(path, "w");
+    if(!f) {
+        printf("cannot write %s\n", path);
+        return 1;
+    }
+    fprintf(f, "{\n  \"benchmarks\": [\n");
+    for(int i = 0; i < nresults; i++) {
+        result_t& r = results[i];
+        fprintf(f, "    {\"name\": \"%s\", \"ops\": %u, \"ns_per_op\": %.3f, "
+                   "\"bus_us_per_op\": %.3f, \"tx_per_s\": %.1f}%s\n",
+                r.name, r.ops, r.ns, r.busUs, r.txps, i < nresults - 1 ? "," : "");
+    }
+    fprintf(f, "  ]\n}\n");
+    fclose(f);
+    printf("results written to %s\n", path);
+    return 0;
+}
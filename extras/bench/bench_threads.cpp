@@ -0,0 +1,110 @@
+/***********************************************************************************************//**
+ *  \brief      MLX90614 host benchmark - multi-bus threaded acquisition.
+ *  \par
+ *  \par        Details
+ *              Runs MLX90614Acquisition over 1 to 6 simulated buses of 4 sensors each. Every bus
+ *              sleeps a real time latency per transaction, so a bus is I/O bound like real
+ *              hardware. Reports the total and per-bus sample rate and the scaling relative to
+ *              one bus, and checks every sample arrives through the shared queue.
+ *  \par        Build
+ *              See extras/README.md.
+ *
+ *  \file       BENCH_THREADS.CPP
+ *  \author     J. F. Fitter <jfitter@eagleairaust.com.au>
+ *  \version    1.0
+ *  \date       2014-2017
+ *  \copyright  Copyright &copy; 2017 John Fitter.  All right reserved.
+ *
+ *  \par        License
+ *              This program is free software; you can redistribute it and/or modify it under
+ *              the terms of the GNU Lesser General Public License as published by the Free
+ *              Software Foundation; either version 2.1 of the License, or (at your option)
+ *              any later version.
+ *  \par
+ *              This Program is distributed in the hope that it will be useful, but WITHOUT ANY
+ *              WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *              PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details
+ *              at http://www.gnu.org/copyleft/gpl.html
+ *  \par
+ *              You should have received a copy of the GNU Lesser General Public License along
+ *              with this library; if not, write to the Free Software Foundation, Inc.,
+ *              51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *//***********************************************************************************************/
+
+#include <stdio.h>
+#include <memory>
+#include "MLX90614Acquire.h"
+#include "MLX90614Sim.h"
+
+static const uint32_t LATENCY = 500;                        // Real time per transaction (us)
+static const uint8_t  SENSORS = 4;                          // Sensors per bus
+static const uint32_t RUNMS = 400;                          // Run time per configuration (ms)
+
+/**
+ *  \brief  Run the engine over a number of buses.
+ *  \return Total samples/s, 0 if samples were lost or misrouted.
+ */
+static double run(uint8_t nbus) {
+    std::unique_ptr<MLX90614SimBus> bus[MLX90614ACQ_MAXBUSES];
+    std::unique_ptr<MLX90614SimDevice> dev[MLX90614ACQ_MAXBUSES][SENSORS];
+    std::unique_ptr<MLX90614> mlx[MLX90614ACQ_MAXBUSES][SENSORS];
+    MLX90614Acquisition acq;
+
+    for(uint8_t b = 0; b < nbus; b++) {
+        bus[b].reset(new MLX90614SimBus);
+        bus[b]->setLatency(LATENCY);
+        int ib = acq.addBus();
+        MLX90614 any(0x10, bus[b].get());
+        if(acq.addSensor(ib, any, MLX90614_ID1)) return 0;  // Not a RAM temperature register
+        for(uint8_t s = 0; s < SENSORS; s++) {
+            dev[b][s].reset(new MLX90614SimDevice(0x10 + s));
+            dev[b][s]->setTemp(MLX90614_TOBJ1, 273.15 + 10 * b + s);
+            bus[b]->attach(*dev[b][s]);
+            mlx[b][s].reset(new MLX90614(0x10 + s, bus[b].get()));
+            mlx[b][s]->begin();
+            if(!acq.addSensor(ib, *mlx[b][s])) return 0;
+        }
+    }
+
+    // Consume while running, checking each sample came from the sensor it claims.
+    uint32_t got = 0, bad = 0;
+    MLX90614Sample smp;
+    acq.start();
+    auto t0 = std::chrono::steady_clock::now();
+    while(std::chrono::steady_clock::now() - t0 < std::chrono::milliseconds(RUNMS)) {
+        if(!acq.pop(smp)) {
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+            continue;
+        }
+        ++got;
+        if(smp.flags || (smp.raw != (uint16_t)((273.15 + 10 * smp.bus + smp.sensor) / 0.02 + 0.5))) ++bad;
+    }
+    acq.stop();
+    while(acq.pop(smp)) ++got;
+
+    uint32_t total = 0, drops = 0;
+    for(uint8_t b = 0; b < nbus; b++) {
+        total += acq.samples(b);
+        drops += acq.drops(b);
+    }
+    double rate = acq.throughput();
+    printf("%u bus%s  %9.0f samples/s  %9.0f per bus", nbus, nbus > 1 ? "es" : "  ", rate, rate / nbus);
+    return (got + drops == total) && !bad ? rate : 0;
+}
+
+int main(void) {
+    const uint8_t nb[] = {1, 2, 4, 6};
+    double r1 = 0;
+    boolean ok = true;
+
+    printf("%u sensors per bus, %u us real latency per transaction\n", SENSORS, LATENCY);
+    for(uint8_t i = 0; i < sizeof(nb); i++) {
+        double r = run(nb[i]);
+        if(i == 0) r1 = r;
+        printf("  scaling %5.2f x\n", r1 ? r / r1 : 0);
+        if(!r || (r < 0.6 * nb[i] * r1)) ok = false;           // Loose, the host may be busy
+    }
+    printf("\nself check %s\n", ok ? "passed" : "FAILED");
+    return ok ? 0 : 1;
+}
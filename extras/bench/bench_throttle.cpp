@@ -0,0 +1,139 @@
+/***********************************************************************************************//**
+ *  \brief      MLX90614 host benchmark - data ready read throttling.
+ *  \par
+ *  \par        Details
+ *              Polls a simulated device that refreshes its object temperature once per
+ *              dataPeriod(), at several loop intervals and FIR settings, with and without read
+ *              throttling. Reports the bus reads issued, the reads avoided, the bus time used and
+ *              how stale the returned data got.
+ *  \par        Build
+ *              See extras/README.md.
+ *
+ *  \file       BENCH_THROTTLE.CPP
+ *  \author     J. F. Fitter <jfitter@eagleairaust.com.au>
+ *  \version    1.0
+ *  \date       2014-2017
+ *  \copyright  Copyright &copy; 2017 John Fitter.  All right reserved.
+ *
+ *  \par        License
+ *              This program is free software; you can redistribute it and/or modify it under
+ *              the terms of the GNU Lesser General Public License as published by the Free
+ *              Software Foundation; either version 2.1 of the License, or (at your option)
+ *              any later version.
+ *  \par
+ *              This Program is distributed in the hope that it will be useful, but WITHOUT ANY
+ *              WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *              PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details
+ *              at http://www.gnu.org/copyleft/gpl.html
+ *  \par
+ *              You should have received a copy of the GNU Lesser General Public License along
+ *              with this library; if not, write to the Free Software Foundation, Inc.,
+ *              51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *//***********************************************************************************************/
+
+#include <stdio.h>
+#include "MLX90614.h"
+#include "MLX90614Sim.h"
+
+#define RUNTIME     10000000UL  /**< Virtual run time per case (us) */
+
+/** Result of one case. */
+struct Result {
+    uint32_t reads;             /**< Bus transactions */
+    uint32_t avoided;           /**< Reads served from the cache */
+    uint32_t busUs;             /**< Time spent in the driver (us) */
+    uint32_t lag;               /**< Worst lag behind the device data (us) */
+};
+
+/**
+ *  \brief  Read TOBJ1 every loop us for RUNTIME. The device output changes every period.
+ */
+static Result run(MLX90614& mlx, MLX90614SimDevice& dev, MLX90614SimBus& bus, uint32_t loop,
+                  boolean throttle) {
+    Result r = {0, 0, 0, 0};
+    uint32_t period = mlx.dataPeriod(), t0 = micros(), tx0 = bus.transactions;
+    uint32_t n = 0, av0 = 0;
+    uint32_t changed = t0;                                  // Time the device data last changed
+
+    mlx.setThrottle(throttle);
+    av0 = mlx.readsAvoided();
+    dev.setRam(MLX90614_TOBJ1, 0x3A00);
+    while((uint32_t)(micros() - t0) < RUNTIME) {
+        // Device refresh.
+        uint32_t k = (micros() - t0) / period;
+        if((uint16_t)(0x3A00 + k) != dev.getRam(MLX90614_TOBJ1)) {
+            dev.setRam(MLX90614_TOBJ1, 0x3A00 + k);
+            changed = t0 + k * period;
+        }
+        uint32_t ts = micros();
+        int32_t v = mlx.readTempFixed(MLX90614::MLX90614_SRC01, MLX90614::MLX90614_TK);
+        r.busUs += micros() - ts;
+        // Lag: time since the device data differed from the value returned.
+        if(v != MLX90614::rawToFixed(dev.getRam(MLX90614_TOBJ1), MLX90614::MLX90614_TK)) {
+            uint32_t lag = micros() - changed;
+            if(lag > r.lag) r.lag = lag;
+        }
+        ++n;
+        hostAdvance(loop);
+    }
+    r.reads = bus.transactions - tx0;
+    r.avoided = mlx.readsAvoided() - av0;
+    mlx.setThrottle(false);
+    return r;
+}
+
+int main(void) {
+    const uint32_t LOOPS[] = {1000, 10000, 250000};
+    const uint8_t FIR[] = {7, 4};
+    MLX90614SimDevice dev;
+    MLX90614SimBus bus;
+    bus.attach(dev);
+    MLX90614 mlx(MLX90614_I2CDEFAULTADDR, &bus);
+    mlx.begin();
+    uint32_t bad = 0;
+
+    printf("FIR  period    loop       plain reads  throttled reads  avoided   bus time saved  worst lag\n");
+    for(uint8_t f = 0; f < sizeof(FIR); f++) {
+        mlx.setFIRcoeff(FIR[f]);
+        uint32_t period = mlx.dataPeriod();
+        for(uint8_t l = 0; l < sizeof(LOOPS) / sizeof(LOOPS[0]); l++) {
+            Result p = run(mlx, dev, bus, LOOPS[l], false);
+            Result t = run(mlx, dev, bus, LOOPS[l], true);
+            printf("%u   %6.1f ms  %6.1f ms   %8u     %8u        %8u   %10.1f ms    %6.1f ms\n",
+                   FIR[f], period / 1000.0, LOOPS[l] / 1000.0, p.reads, t.reads, t.avoided,
+                   (p.busUs - t.busUs) / 1000.0, t.lag / 1000.0);
+            // At most one read per period (plus the first), never more than the plain loop,
+            // and the data is never more than one period plus one loop behind.
+            if(t.reads > p.reads || t.reads > RUNTIME / period + 2 ||
+               t.lag > period + LOOPS[l] + p.busUs / (p.reads ? p.reads : 1)) ++bad;
+            if(LOOPS[l] < period && !t.avoided) ++bad;
+        }
+    }
+
+    // A failed ConfigRegister1 read must not leave a wrong (default 100 ms) period behind.
+    mlx.setFIRcoeff(4);
+    mlx.setThrottle(true);
+    mlx.readTemp();
+    mlx.invalidate();
+    dev.injectFault(MLX90614SIM_NACKADDR, 1);
+    mlx.readTemp();                                         // Config read fails, goes to the bus
+    hostAdvance(mlx.dataPeriod() + 1000);
+    uint32_t av = mlx.readsAvoided(), tx = bus.transactions;
+    mlx.readTemp();
+    boolean fresh = (mlx.readsAvoided() == av) && (bus.transactions != tx) && !mlx.sampleAge();
+    printf("after a config read error: %s\n", fresh ? "fresh read" : "STALE CACHE");
+    if(!fresh) ++bad;
+
+    // invalidate() (also run by an address change) drops the cached RAM values.
+    mlx.readTemp();
+    mlx.invalidate();
+    av = mlx.readsAvoided();
+    mlx.readTemp();
+    fresh = (mlx.readsAvoided() == av) && !mlx.sampleAge();
+    printf("after invalidate(): %s\n", fresh ? "fresh read" : "STALE CACHE");
+    if(!fresh) ++bad;
+    mlx.setThrottle(false);
+
+    return bad ? 1 : 0;
+}
@@ -0,0 +1,101 @@
+/***********************************************************************************************//**
+ *  \brief      MLX90614 host benchmark - per-transaction overhead through the bus transport.
+ *  \par
+ *  \par        Details
+ *              Runs the unmodified driver against the simulated device and reports the host CPU
+ *              cost of each transaction and the throughput the simulated 100kHz bus allows.
+ *  \par        Build
+ *              See extras/README.md.
+ *
+ *  \file       BENCH_TRANSPORT.CPP
+ *  \author     J. F. Fitter <jfitter@eagleairaust.com.au>
+ *  \version    1.0
+ *  \date       2014-2017
+ *  \copyright  Copyright &copy; 2017 John Fitter.  All right reserved.
+ *
+ *  \par        License
+ *              This program is free software; you can redistribute it and/or modify it under
+ *              the terms of the GNU Lesser General Public License as published by the Free
+ *              Software Foundation; either version 2.1 of the License, or (at your option)
+ *              any later version.
+ *  \par
+ *              This Program is distributed in the hope that it will be useful, but WITHOUT ANY
+ *              WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *              PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details
+ *              at http://www.gnu.org/copyleft/gpl.html
+ *  \par
+ *              You should have received a copy of the GNU Lesser General Public License along
+ *              with this library; if not, write to the Free Software Foundation, Inc.,
+ *              51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *//***********************************************************************************************/
+
+#include <stdio.h>
+#include <chrono>
+#include "MLX90614.h"
+#include "MLX90614Sim.h"
+
+static volatile double sink;
+
+int main(void) {
+    const uint32_t N = 200000;
+    MLX90614SimDevice dev;
+    MLX90614SimBus bus;
+    bus.attach(dev);
+    MLX90614 mlx(MLX90614_I2CDEFAULTADDR, &bus);
+    mlx.begin();
+
+    // Host CPU cost per readTemp() (driver + simulated transport).
+    auto t0 = std::chrono::steady_clock::now();
+    uint32_t v0 = micros(), tx0 = bus.transactions;
+    for(uint32_t i = 0; i < N; i++) sink = mlx.readTemp();
+    auto t1 = std::chrono::steady_clock::now();
+    uint32_t vus = micros() - v0, ntx = bus.transactions - tx0;
+
+    double ns = std::chrono::duration<double, std::nano>(t1 - t0).count() / N;
+    printf("readTemp        %8.1f ns/op (host)   %8.1f us/op (bus)   %8.0f tx/s (bus)\n",
+           ns, (double)vus / N, ntx * 1e6 / vus);
+
+    // Three channels via readTemp() versus one readAll() snapshot.
+    MLX90614::snapshot_t snap;
+    t0 = std::chrono::steady_clock::now();
+    for(uint32_t i = 0; i < N; i++) {
+        sink = mlx.readTemp(MLX90614::MLX90614_SRCA);
+        sink = mlx.readTemp(MLX90614::MLX90614_SRC01);
+        sink = mlx.readTemp(MLX90614::MLX90614_SRC02);
+    }
+    t1 = std::chrono::steady_clock::now();
+    ns = std::chrono::duration<double, std::nano>(t1 - t0).count() / N;
+    printf("3 x readTemp    %8.1f ns/op (host)\n", ns);
+
+    t0 = std::chrono::steady_clock::now();
+    for(uint32_t i = 0; i < N; i++) {
+        mlx.readAll(snap, MLX90614_CHTA | MLX90614_CHTOBJ1 | MLX90614_CHTOBJ2);
+        sink = snap.raw[2];
+    }
+    t1 = std::chrono::steady_clock::now();
+    ns = std::chrono::duration<double, std::nano>(t1 - t0).count() / N;
+    printf("readAll (3 ch)  %8.1f ns/op (host)\n", ns);
+
+    // Configuration getters are served from the EEPROM shadow after the first read.
+    tx0 = bus.transactions;
+    t0 = std::chrono::steady_clock::now();
+    for(uint32_t i = 0; i < N; i++) sink = mlx.getIIRcoeff() + mlx.getFIRcoeff() + mlx.getEmissivity();
+    t1 = std::chrono::steady_clock::now();
+    ns = std::chrono::duration<double, std::nano>(t1 - t0).count() / N;
+    printf("3 x config get  %8.1f ns/op (host)   %u bus transactions for %u calls\n",
+           ns, bus.transactions - tx0, 3 * N);
+
+    // Faulty transactions still cost a full exchange.
+    uint32_t errs = 0;
+    dev.injectFault(MLX90614SIM_BADPEC, N / 2);
+    t0 = std::chrono::steady_clock::now();
+    for(uint32_t i = 0; i < N; i++) {
+        sink = mlx.readTemp();
+        if(mlx.rwError) ++errs;
+    }
+    t1 = std::chrono::steady_clock::now();
+    ns = std::chrono::duration<double, std::nano>(t1 - t0).count() / N;
+    printf("readTemp/faults %8.1f ns/op (host)   %u/%u PEC errors detected\n", ns, errs, N / 2);
+    return errs == N / 2 ? 0 : 1;
+}
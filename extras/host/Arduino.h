@@ -0,0 +1,62 @@
+#ifndef _HOST_ARDUINO_H_
+#define _HOST_ARDUINO_H_
+
+/***********************************************************************************************//**
+ *  \brief      Host (Linux) stand-in for the Arduino core header.
+ *  \par
+ *  \par        Details
+ *              Provides just enough of the Arduino core API to build the MLX90614 library with
+ *              plain g++ on a host computer. Build with <tt>-DARDUINO=100 -Iextras/host</tt>.
+ *  \li         Time is simulated. micros() and millis() return a virtual clock that only moves
+ *              when delay(), delayMicroseconds() or hostAdvance() are called. Simulated buses
+ *              advance it by the time each transaction would take on the wire.
+ *  \li         The clock is thread local so that each thread (eg. each bus worker) runs on its
+ *              own timeline.
+ *
+ *  \file       ARDUINO.H
+ *  \author     J. F. Fitter <jfitter@eagleairaust.com.au>
+ *  \version    1.0
+ *  \date       2014-2017
+ *  \copyright  Copyright &copy; 2017 John Fitter.  All right reserved.
+ *
+ *  \par        License
+ *              This program is free software; you can redistribute it and/or modify it under
+ *              the terms of the GNU Lesser General Public License as published by the Free
+ *              Software Foundation; either version 2.1 of the License, or (at your option)
+ *              any later version.
+ *  \par
+ *              This Program is distributed in the hope that it will be useful, but WITHOUT ANY
+ *              WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *              PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details
+ *              at http://www.gnu.org/copyleft/gpl.html
+ *  \par
+ *              You should have received a copy of the GNU Lesser General Public License along
+ *              with this library; if not, write to the Free Software Foundation, Inc.,
+ *              51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *//***********************************************************************************************/
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <math.h>
+
+typedef bool    boolean;
+typedef uint8_t byte;
+
+#define lowByte(w)  ((uint8_t)((w) & 0xff))
+#define highByte(w) ((uint8_t)((w) >> 8))
+#define F(s)        (s)
+
+/** Virtual clock in microseconds (thread local). */
+inline uint32_t& hostClock(void) {static thread_local uint32_t us = 0; return us;}
+
+inline void     hostAdvance(uint32_t us)      {hostClock() += us;}
+inline uint32_t micros(void)                  {return hostClock();}
+inline uint32_t millis(void)                  {return hostClock() / 1000;}
+inline void     delayMicroseconds(uint32_t us){hostAdvance(us);}
+inline void     delay(uint32_t ms)            {hostAdvance(ms * 1000);}
+inline void     noInterrupts(void)            {}
+inline void     interrupts(void)              {}
+
+#endif /* _HOST_ARDUINO_H_ */
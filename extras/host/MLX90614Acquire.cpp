@@ -0,0 +1,138 @@
+/***********************************************************************************************//**
+ *  \brief      Melexis MLX90614 Family Device Driver Library - Multi-bus threaded acquisition (host).
+ *  \file       MLX90614ACQUIRE.CPP
+ *  \author     J. F. Fitter <jfitter@eagleairaust.com.au>
+ *  \version    1.0
+ *  \date       2014-2017
+ *  \copyright  Copyright &copy; 2017 John Fitter.  All right reserved.
+ *
+ *  \par        License
+ *              This program is free software; you can redistribute it and/or modify it under
+ *              the terms of the GNU Lesser General Public License as published by the Free
+ *              Software Foundation; either version 2.1 of the License, or (at your option)
+ *              any later version.
+ *  \par
+ *              This Program is distributed in the hope that it will be useful, but WITHOUT ANY
+ *              WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *              PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details
+ *              at http://www.gnu.org/copyleft/gpl.html
+ *  \par
+ *              You should have received a copy of the GNU Lesser General Public License along
+ *              with this library; if not, write to the Free Software Foundation, Inc.,
+ *              51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *//***********************************************************************************************/
+
+#include "MLX90614Acquire.h"
+
+/**************************************************************************************************/
+/*  Multi-bus acquisition engine functions.                                                       */
+/**************************************************************************************************/
+
+MLX90614Acquisition::MLX90614Acquisition() {
+    _nbus = 0;
+    _run = false;
+    _seconds = 0;
+}
+
+MLX90614Acquisition::~MLX90614Acquisition() {stop();}
+
+/**
+ *  \brief            Add a bus. Its sensors must all use one transport not shared with other buses.
+ *  \return           Bus index, -1 if full or running.
+ */
+int MLX90614Acquisition::addBus(void) {
+
+    if(_run || (_nbus >= MLX90614ACQ_MAXBUSES)) return -1;
+    bus_t& b = _bus[_nbus];
+    b.count = 0;
+    b.samples = b.errors = b.drops = 0;
+    return _nbus++;
+}
+
+/**
+ *  \brief            Add a sensor to a bus.
+ *  \param [in] bus   Bus index from addBus().
+ *  \param [in] dev   Device, owned by the caller, used only by the bus worker while running.
+ *  \param [in] reg   RAM register to read, MLX90614_RAWIR1 to MLX90614_TOBJ2 (default
+ *                    MLX90614_TOBJ1).
+ *  \return           False if the register is out of range, the bus is full or the engine is
+ *                    running.
+ */
+boolean MLX90614Acquisition::addSensor(uint8_t bus, MLX90614& dev, uint8_t reg) {
+
+    if(_run || (bus >= _nbus)) return false;
+    if((reg < MLX90614_RAWIR1) || (reg > MLX90614_TOBJ2)) return false;
+    bus_t& b = _bus[bus];
+    if(b.count >= MLX90614ACQ_MAXSENSORS) return false;
+    b.dev[b.count] = &dev;
+    b.reg[b.count++] = reg;
+    return true;
+}
+
+/**
+ *  \brief            Start one worker per bus.
+ */
+boolean MLX90614Acquisition::start(void) {
+
+    if(_run) return false;
+    _run = true;
+    _t0 = std::chrono::steady_clock::now();
+    for(uint8_t i = 0; i < _nbus; i++) {
+        _bus[i].samples = _bus[i].errors = _bus[i].drops = 0;
+        _bus[i].worker = std::thread(&MLX90614Acquisition::work, this, i);
+    }
+    return true;
+}
+
+/**
+ *  \brief            Stop and join the workers.
+ */
+void MLX90614Acquisition::stop(void) {
+
+    if(!_run) return;
+    _run = false;
+    for(uint8_t i = 0; i < _nbus; i++) if(_bus[i].worker.joinable()) _bus[i].worker.join();
+    _seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - _t0).count();
+}
+
+double MLX90614Acquisition::throughput(uint8_t bus) {
+    double s = _run ? std::chrono::duration<double>(std::chrono::steady_clock::now() - _t0).count()
+                    : _seconds;
+    return s > 0 ? _bus[bus].samples.load() / s : 0;
+}
+
+double MLX90614Acquisition::throughput(void) {
+    double t = 0;
+    for(uint8_t i = 0; i < _nbus; i++) t += throughput(i);
+    return t;
+}
+
+uint32_t MLX90614Acquisition::now(void) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now() - _t0).count();
+}
+
+/**
+ *  \brief            Bus worker - read the sensors round robin until stopped.
+ */
+void MLX90614Acquisition::work(uint8_t bus) {
+    bus_t& b = _bus[bus];
+    MLX90614::snapshot_t snap;
+    MLX90614Sample s;
+
+    s.bus = bus;
+    while(_run.load(std::memory_order_relaxed)) {
+        for(uint8_t i = 0; i < b.count; i++) {
+            uint8_t ch = b.reg[i] - MLX90614_RAWIR1;
+            s.timestamp = now();
+            s.flags = b.dev[i]->readAll(snap, 1 << ch);
+            s.raw = snap.raw[ch];
+            s.channel = b.reg[i];
+            s.sensor = i;
+            b.samples.fetch_add(1, std::memory_order_relaxed);
+            if(s.flags) b.errors.fetch_add(1, std::memory_order_relaxed);
+            if(!queue.push(s)) b.drops.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+}
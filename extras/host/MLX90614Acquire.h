@@ -0,0 +1,164 @@
+#ifndef _MLX90614ACQUIRE_H_
+#define _MLX90614ACQUIRE_H_
+
+/***********************************************************************************************//**
+ *  \brief      Melexis MLX90614 Family Device Driver Library - Multi-bus threaded acquisition (host).
+ *  \par
+ *  \par        Details
+ *              Drives sensors spread over several buses in parallel, one worker thread per bus.
+ *              Each worker reads its sensors round robin and publishes the samples into one
+ *              shared bounded lock-free queue that the application drains.
+ *  \li         A bus, its transport and its MLX90614 objects are only touched by its worker.
+ *  \li         MLX90614Queue is a bounded multi-producer / multi-consumer queue (one sequence
+ *              number per cell), no locks and no allocation after construction.
+ *  \li         Samples that find the queue full are dropped and counted per bus.
+ *  \li         Per-bus samples, errors, drops and throughput are reported.
+ *
+ *  \file       MLX90614ACQUIRE.H
+ *  \author     J. F. Fitter <jfitter@eagleairaust.com.au>
+ *  \version    1.0
+ *  \date       2014-2017
+ *  \copyright  Copyright &copy; 2017 John Fitter.  All right reserved.
+ *
+ *  \par        License
+ *              This program is free software; you can redistribute it and/or modify it under
+ *              the terms of the GNU Lesser General Public License as published by the Free
+ *              Software Foundation; either version 2.1 of the License, or (at your option)
+ *              any later version.
+ *  \par
+ *              This Program is distributed in the hope that it will be useful, but WITHOUT ANY
+ *              WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *              PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details
+ *              at http://www.gnu.org/copyleft/gpl.html
+ *  \par
+ *              You should have received a copy of the GNU Lesser General Public License along
+ *              with this library; if not, write to the Free Software Foundation, Inc.,
+ *              51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *//***********************************************************************************************/
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include "MLX90614.h"
+
+#define MLX90614ACQ_MAXBUSES    8           /**< Maximum buses */
+#define MLX90614ACQ_MAXSENSORS  16          /**< Maximum sensors per bus */
+
+/** Published sample. */
+struct MLX90614Sample {
+    uint32_t timestamp;                                     /**< Time since start() (us) */
+    uint16_t raw;                                           /**< Raw register value */
+    uint8_t  flags;                                         /**< R/W error flags */
+    uint8_t  channel;                                       /**< RAM register read */
+    uint8_t  bus;                                           /**< Bus index */
+    uint8_t  sensor;                                        /**< Sensor index on the bus */
+};
+
+/**************************************************************************************************/
+/* Bounded lock-free MPMC queue.                                                                  */
+/**************************************************************************************************/
+
+template<typename T, uint32_t N> class MLX90614Queue {
+    static_assert(N && !(N & (N - 1)), "Capacity must be a power of 2");
+public:
+    MLX90614Queue() : _head(0), _tail(0) {
+        for(uint32_t i = 0; i < N; i++) _cell[i].seq.store(i, std::memory_order_relaxed);
+    }
+
+    /** Add an item, false if the queue is full. */
+    bool push(const T& item) {
+        uint32_t pos = _tail.load(std::memory_order_relaxed);
+
+        for(;;) {
+            cell_t& c = _cell[pos & (N - 1)];
+            int32_t dif = (int32_t)(c.seq.load(std::memory_order_acquire) - pos);
+            if(dif == 0) {
+                if(_tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    c.item = item;
+                    c.seq.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if(dif < 0) return false;
+            else pos = _tail.load(std::memory_order_relaxed);
+        }
+    }
+
+    /** Remove the oldest item, false if the queue is empty. */
+    bool pop(T& item) {
+        uint32_t pos = _head.load(std::memory_order_relaxed);
+
+        for(;;) {
+            cell_t& c = _cell[pos & (N - 1)];
+            int32_t dif = (int32_t)(c.seq.load(std::memory_order_acquire) - (pos + 1));
+            if(dif == 0) {
+                if(_head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    item = c.item;
+                    c.seq.store(pos + N, std::memory_order_release);
+                    return true;
+                }
+            } else if(dif < 0) return false;
+            else pos = _head.load(std::memory_order_relaxed);
+        }
+    }
+
+private:
+    struct cell_t {
+        std::atomic<uint32_t> seq;
+        T item;
+    };
+
+    cell_t   _cell[N];
+    alignas(64) std::atomic<uint32_t> _head;                /**< Next item to pop */
+    alignas(64) std::atomic<uint32_t> _tail;                /**< Next cell to push */
+};
+
+/**************************************************************************************************/
+/* Multi-bus acquisition engine.                                                                  */
+/**************************************************************************************************/
+
+class MLX90614Acquisition {
+public:
+    typedef MLX90614Queue<MLX90614Sample, 4096> queue_t;
+
+    MLX90614Acquisition();
+    ~MLX90614Acquisition();
+
+    int      addBus(void);                                  /**< New bus, returns index or -1 */
+    boolean  addSensor(uint8_t bus, MLX90614& dev, uint8_t reg = MLX90614_TOBJ1);
+    boolean  start(void);
+    void     stop(void);
+
+    boolean  pop(MLX90614Sample& s) {return queue.pop(s);}  /**< Take the oldest sample */
+
+    uint8_t  buses(void) {return _nbus;}
+    uint32_t samples(uint8_t bus) {return _bus[bus].samples.load();}   /**< Samples read */
+    uint32_t errors(uint8_t bus)  {return _bus[bus].errors.load();}    /**< Reads with errors */
+    uint32_t drops(uint8_t bus)   {return _bus[bus].drops.load();}     /**< Samples lost, queue full */
+    double   throughput(uint8_t bus);                       /**< Samples/s over the run */
+    double   throughput(void);                              /**< Samples/s, all buses */
+
+    queue_t  queue;                                         /**< Shared sample queue */
+
+private:
+    struct bus_t {
+        MLX90614* dev[MLX90614ACQ_MAXSENSORS];
+        uint8_t  reg[MLX90614ACQ_MAXSENSORS];
+        uint8_t  count;
+        std::thread worker;
+        std::atomic<uint32_t> samples;
+        std::atomic<uint32_t> errors;
+        std::atomic<uint32_t> drops;
+    };
+
+    bus_t    _bus[MLX90614ACQ_MAXBUSES];
+    uint8_t  _nbus;
+    std::atomic<bool> _run;
+    std::chrono::steady_clock::time_point _t0;
+    double   _seconds;                                      /**< Length of the last run */
+
+    void     work(uint8_t bus);
+    uint32_t now(void);
+};
+
+#endif /* _MLX90614ACQUIRE_H_ */
@@ -0,0 +1,294 @@
+/***********************************************************************************************//**
+ *  \brief      Melexis MLX90614 Family Device Driver Library - Linux i2c-dev transport (host).
+ *  \file       MLX90614LINUXBUS.CPP
+ *  \author     J. F. Fitter <jfitter@eagleairaust.com.au>
+ *  \version    1.0
+ *  \date       2014-2017
+ *  \copyright  Copyright &copy; 2017 John Fitter.  All right reserved.
+ *
+ *  \par        License
+ *              This program is free software; you can redistribute it and/or modify it under
+ *              the terms of the GNU Lesser General Public License as published by the Free
+ *              Software Foundation; either version 2.1 of the License, or (at your option)
+ *              any later version.
+ *  \par
+ *              This Program is distributed in the hope that it will be useful, but WITHOUT ANY
+ *              WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *              PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details
+ *              at http://www.gnu.org/copyleft/gpl.html
+ *  \par
+ *              You should have received a copy of the GNU Lesser General Public License along
+ *              with this library; if not, write to the Free Software Foundation, Inc.,
+ *              51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *//***********************************************************************************************/
+
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <linux/i2c.h>
+#include <linux/i2c-dev.h>
+#include "MLX90614LinuxBus.h"
+
+/**************************************************************************************************/
+/*  System call table.                                                                            */
+/**************************************************************************************************/
+
+static int sysOpen(void*, const char* path)                     {return ::open(path, O_RDWR);}
+static int sysClose(void*, int fd)                              {return ::close(fd);}
+static int sysIoctl(void*, int fd, unsigned long req, void* arg) {return ::ioctl(fd, req, arg);}
+
+const MLX90614I2cOps MLX90614I2cSys = {sysOpen, sysClose, sysIoctl, NULL};
+
+/**
+ *  \brief            PEC of a read word as the device would send it.
+ */
+static uint8_t readPec(uint8_t addr, uint8_t cmd, uint8_t lo, uint8_t hi) {
+    CRC8 crc(MLX90614_CRC8POLY);
+
+    crc.crc8(addr << 1);
+    crc.crc8(cmd);
+    crc.crc8((addr << 1) + 1);
+    crc.crc8(lo);
+    return crc.crc8(hi);
+}
+
+/**************************************************************************************************/
+/*  Linux i2c-dev bus transport functions.                                                        */
+/**************************************************************************************************/
+
+/**
+ *  \brief               Open the i2c-dev device node.
+ *  \param [in] path     Device node, eg. /dev/i2c-1.
+ *  \param [in] smbusPec Use the kernel SMBus word transfers with PEC instead of I2C_RDWR.
+ *  \param [in] ops      System call table (default the real system calls).
+ */
+MLX90614LinuxBus::MLX90614LinuxBus(const char* path, boolean smbusPec, const MLX90614I2cOps& ops) {
+    _ops = ops;
+    _pec = smbusPec;
+    _slave = -1;
+    _cmdValid = false;
+    _fd = _ops.open(_ops.ctx, path);
+}
+
+MLX90614LinuxBus::~MLX90614LinuxBus() {if(_fd >= 0) _ops.close(_ops.ctx, _fd);}
+
+/**
+ *  \brief            Convert an ioctl result to R/W error flags.
+ */
+uint8_t MLX90614LinuxBus::error(int ret) {
+
+    if(ret >= 0) return MLX90614_NORWERROR;
+    switch(errno) {
+        case ENXIO     : return MLX90614_TXADDRNACK;
+        case EREMOTEIO : return MLX90614_TXDATANACK;
+        default        : return MLX90614_TXOTHER;
+    }
+}
+
+/**
+ *  \brief            Select the slave address for the SMBus path (cached).
+ */
+uint8_t MLX90614LinuxBus::slave(uint8_t addr) {
+
+    if(_slave == addr) return MLX90614_NORWERROR;
+    if(_ops.ioctl(_ops.ctx, _fd, I2C_SLAVE, (void*)(uintptr_t)addr) < 0) {
+        _slave = -1;
+        return MLX90614_TXOTHER;
+    }
+    if(_slave < 0) _ops.ioctl(_ops.ctx, _fd, I2C_PEC, (void*)1);
+    _slave = addr;
+    return MLX90614_NORWERROR;
+}
+
+/**
+ *  \brief            Record the command, the transaction is performed by receive().
+ */
+uint8_t MLX90614LinuxBus::sendCommand(uint8_t addr, uint8_t cmd) {
+
+    if(_fd < 0) return MLX90614_TXOTHER;
+    _cmdAddr = addr;
+    _cmd = cmd;
+    _cmdValid = true;
+    return MLX90614_NORWERROR;
+}
+
+/**
+ *  \brief            Perform the read word transaction (command, repeated start, read).
+ */
+uint8_t MLX90614LinuxBus::receive(uint8_t addr, uint8_t* buf, uint8_t len) {
+    uint8_t err;
+
+    memset(buf, 0xff, len);
+    if(!_cmdValid || (addr != _cmdAddr)) return MLX90614_NORWERROR;
+    _cmdValid = false;
+
+    if(_pec) {
+        union i2c_smbus_data data;
+        struct i2c_smbus_ioctl_data args = {I2C_SMBUS_READ, _cmd, I2C_SMBUS_WORD_DATA, &data};
+        if((err = slave(addr))) return err;
+        int ret = _ops.ioctl(_ops.ctx, _fd, I2C_SMBUS, &args);
+
+        // On a bad PEC the kernel does not copy the data back, there is nothing to return.
+        if(ret < 0) return (errno == EBADMSG) ? MLX90614_RXCRC : error(ret);
+
+        // The kernel checked the PEC, give the driver one that matches.
+        uint8_t out[3] = {lowByte(data.word), highByte(data.word), 0};
+        out[2] = readPec(addr, _cmd, out[0], out[1]);
+        for(uint8_t i = 0; i < len && i < 3; i++) buf[i] = out[i];
+        return MLX90614_NORWERROR;
+    }
+
+    struct i2c_msg msgs[2] = {
+        {addr, 0, 1, &_cmd},
+        {addr, I2C_M_RD, len, buf}
+    };
+    struct i2c_rdwr_ioctl_data args = {msgs, 2};
+    int ret = _ops.ioctl(_ops.ctx, _fd, I2C_RDWR, &args);
+    if(ret < 0) memset(buf, 0xff, len);
+    return error(ret);
+}
+
+/**
+ *  \brief            Write word transaction (command, data low, data high, PEC).
+ */
+uint8_t MLX90614LinuxBus::transmit(uint8_t addr, const uint8_t* buf, uint8_t len) {
+    uint8_t err;
+
+    _cmdValid = false;
+    if(_fd < 0) return MLX90614_TXOTHER;
+
+    // Write word (command, data, PEC) or send byte (command, PEC, eg. the sleep command), the
+    // kernel appends its own PEC.
+    if(_pec) {
+        union i2c_smbus_data data;
+        struct i2c_smbus_ioctl_data args = {I2C_SMBUS_WRITE, buf[0], I2C_SMBUS_WORD_DATA, &data};
+        if(len == 4) data.word = buf[1] | (buf[2] << 8);
+        else if(len == 2) {
+            args.size = I2C_SMBUS_BYTE;
+            args.data = NULL;
+        } else return MLX90614_DATATOOLONG;
+        if((err = slave(addr))) return err;
+        return error(_ops.ioctl(_ops.ctx, _fd, I2C_SMBUS, &args));
+    }
+
+    struct i2c_msg msg = {addr, 0, len, (uint8_t*)buf};
+    struct i2c_rdwr_ioctl_data args = {&msg, 1};
+    return error(_ops.ioctl(_ops.ctx, _fd, I2C_RDWR, &args));
+}
+
+/**************************************************************************************************/
+/*  Fake i2c-dev system call functions.                                                           */
+/**************************************************************************************************/
+
+/**
+ *  \brief               Fake system calls constructor.
+ *  \param [in] bus      Simulated bus the transfers are routed to.
+ *  \param [in] rdwr     Adapter supports I2C_RDWR (false = SMBus transfers only).
+ */
+MLX90614I2cFake::MLX90614I2cFake(MLX90614SimBus& bus, boolean rdwr) {
+    _bus = &bus;
+    _rdwr = rdwr;
+    _slave = -1;
+    _pecOn = false;
+    ioctls = 0;
+    ops.open = sysOpen;
+    ops.close = sysClose;
+    ops.ioctl = sysIoctl;
+    ops.ctx = this;
+}
+
+int MLX90614I2cFake::sysOpen(void*, const char*)  {return 3;}
+int MLX90614I2cFake::sysClose(void*, int)         {return 0;}
+int MLX90614I2cFake::sysIoctl(void* ctx, int, unsigned long req, void* arg) {
+    return ((MLX90614I2cFake*)ctx)->ioctl(req, arg);
+}
+
+/**
+ *  \brief            Set errno from R/W error flags as the i2c core would.
+ */
+static int fail(uint8_t err) {
+
+    errno = err & MLX90614_TXADDRNACK ? ENXIO : err & MLX90614_TXDATANACK ? EREMOTEIO : EIO;
+    return -1;
+}
+
+int MLX90614I2cFake::ioctl(unsigned long req, void* arg) {
+    uint8_t err;
+
+    ++ioctls;
+    switch(req) {
+        case I2C_SLAVE :
+            _slave = (int)(uintptr_t)arg;
+            return 0;
+
+        case I2C_PEC :
+            _pecOn = arg != NULL;
+            return 0;
+
+        case I2C_RDWR : {
+            if(!_rdwr) {
+                errno = EOPNOTSUPP;
+                return -1;
+            }
+            struct i2c_rdwr_ioctl_data* d = (struct i2c_rdwr_ioctl_data*)arg;
+            if((d->nmsgs == 2) && !(d->msgs[0].flags & I2C_M_RD) && (d->msgs[0].len == 1)
+                               && (d->msgs[1].flags & I2C_M_RD)) {
+                if((err = _bus->sendCommand(d->msgs[0].addr, d->msgs[0].buf[0]))) {
+                    _bus->receive(d->msgs[1].addr, d->msgs[1].buf, d->msgs[1].len);
+                    return fail(err);
+                }
+                err = _bus->receive(d->msgs[1].addr, d->msgs[1].buf, d->msgs[1].len);
+                return err ? fail(err) : 2;
+            }
+            if((d->nmsgs == 1) && !(d->msgs[0].flags & I2C_M_RD)) {
+                err = _bus->transmit(d->msgs[0].addr, d->msgs[0].buf, d->msgs[0].len);
+                return err ? fail(err) : 1;
+            }
+            errno = EINVAL;
+            return -1;
+        }
+
+        case I2C_SMBUS : {
+            struct i2c_smbus_ioctl_data* d = (struct i2c_smbus_ioctl_data*)arg;
+            boolean word = d->size == I2C_SMBUS_WORD_DATA;
+            boolean send = (d->size == I2C_SMBUS_BYTE) && (d->read_write == I2C_SMBUS_WRITE);
+            if((_slave < 0) || !(word || send)) {
+                errno = EINVAL;
+                return -1;
+            }
+            if(send) {
+                CRC8 crc(MLX90614_CRC8POLY);
+                uint8_t buf[2] = {d->command, 0};
+                crc.crc8(_slave << 1);
+                buf[1] = crc.crc8(d->command);
+                err = _bus->transmit(_slave, buf, _pecOn ? 2 : 1);
+                return err ? fail(err) : 0;
+            }
+            if(d->read_write == I2C_SMBUS_READ) {
+                uint8_t buf[3];
+                if((err = _bus->sendCommand(_slave, d->command))) {
+                    _bus->receive(_slave, buf, 3);
+                    return fail(err);
+                }
+                if((err = _bus->receive(_slave, buf, _pecOn ? 3 : 2))) return fail(err);
+                // Like the kernel, the data is not copied back if the PEC is wrong.
+                if(_pecOn && (readPec(_slave, d->command, buf[0], buf[1]) != buf[2])) {
+                    errno = EBADMSG;
+                    return -1;
+                }
+                d->data->word = buf[0] | (buf[1] << 8);
+                return 0;
+            }
+            CRC8 crc(MLX90614_CRC8POLY);
+            uint8_t buf[4] = {d->command, lowByte(d->data->word), highByte(d->data->word), 0};
+            crc.crc8(_slave << 1);
+            for(uint8_t i = 0; i < 3; i++) buf[3] = crc.crc8(buf[i]);
+            err = _bus->transmit(_slave, buf, _pecOn ? 4 : 3);
+            return err ? fail(err) : 0;
+        }
+    }
+    errno = ENOTTY;
+    return -1;
+}
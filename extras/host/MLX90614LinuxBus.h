@@ -0,0 +1,108 @@
+#ifndef _MLX90614LINUXBUS_H_
+#define _MLX90614LINUXBUS_H_
+
+/***********************************************************************************************//**
+ *  \brief      Melexis MLX90614 Family Device Driver Library - Linux i2c-dev transport (host).
+ *  \par
+ *  \par        Details
+ *              Runs the driver on a Linux single board computer through /dev/i2c-N.
+ *  \li         A read word is one I2C_RDWR ioctl: command write then a 3 byte read after a
+ *              repeated start. sendCommand() only records the command, receive() performs the
+ *              whole transaction, so no turnaround delay (MLX90614_XDLY) is needed.
+ *  \li         A write word is one I2C_RDWR ioctl with a single write message.
+ *  \li         Optional SMBus PEC path (I2C_SMBUS read/write word with I2C_PEC set) for adapters
+ *              without I2C_RDWR. The kernel checks and appends the PEC, a PEC mismatch is passed
+ *              on to the driver as a bad PEC byte.
+ *  \li         Errors: ENXIO = address NACK, EREMOTEIO = data NACK, anything else = TXOTHER.
+ *  \li         The system calls go through an MLX90614I2cOps table, MLX90614I2cFake routes them
+ *              to a simulated bus so the transport can be tested without hardware.
+ *
+ *  \file       MLX90614LINUXBUS.H
+ *  \author     J. F. Fitter <jfitter@eagleairaust.com.au>
+ *  \version    1.0
+ *  \date       2014-2017
+ *  \copyright  Copyright &copy; 2017 John Fitter.  All right reserved.
+ *
+ *  \par        License
+ *              This program is free software; you can redistribute it and/or modify it under
+ *              the terms of the GNU Lesser General Public License as published by the Free
+ *              Software Foundation; either version 2.1 of the License, or (at your option)
+ *              any later version.
+ *  \par
+ *              This Program is distributed in the hope that it will be useful, but WITHOUT ANY
+ *              WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *              PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details
+ *              at http://www.gnu.org/copyleft/gpl.html
+ *  \par
+ *              You should have received a copy of the GNU Lesser General Public License along
+ *              with this library; if not, write to the Free Software Foundation, Inc.,
+ *              51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *//***********************************************************************************************/
+
+#include "MLX90614Sim.h"
+
+/** System call table. */
+struct MLX90614I2cOps {
+    int   (*open)(void* ctx, const char* path);
+    int   (*close)(void* ctx, int fd);
+    int   (*ioctl)(void* ctx, int fd, unsigned long req, void* arg);
+    void* ctx;
+};
+
+extern const MLX90614I2cOps MLX90614I2cSys;                 /**< The real system calls */
+
+/**************************************************************************************************/
+/* Linux i2c-dev bus transport.                                                                   */
+/**************************************************************************************************/
+
+class MLX90614LinuxBus : public MLX90614Bus {
+public:
+    MLX90614LinuxBus(const char* path = "/dev/i2c-1", boolean smbusPec = false,
+                     const MLX90614I2cOps& ops = MLX90614I2cSys);
+    ~MLX90614LinuxBus();
+
+    boolean  isOpen(void) {return _fd >= 0;}                /**< Device node was opened */
+
+    uint8_t  sendCommand(uint8_t addr, uint8_t cmd);
+    uint8_t  receive(uint8_t addr, uint8_t* buf, uint8_t len);
+    uint8_t  transmit(uint8_t addr, const uint8_t* buf, uint8_t len);
+    uint16_t turnaround(void) {return 0;}
+
+private:
+    MLX90614I2cOps _ops;
+    int      _fd;
+    boolean  _pec;                                          /**< Use the SMBus PEC path */
+    int      _slave;                                        /**< Address set by I2C_SLAVE, -1 = none */
+    uint8_t  _cmd;                                          /**< Command of the read in progress */
+    uint8_t  _cmdAddr;                                      /**< Address of the read in progress */
+    boolean  _cmdValid;
+
+    uint8_t  error(int ret);
+    uint8_t  slave(uint8_t addr);
+};
+
+/**************************************************************************************************/
+/* Fake i2c-dev system calls, routed to a simulated bus.                                          */
+/**************************************************************************************************/
+
+class MLX90614I2cFake {
+public:
+    MLX90614I2cFake(MLX90614SimBus& bus, boolean rdwr = true);
+
+    MLX90614I2cOps ops;                                     /**< Table to pass to MLX90614LinuxBus */
+    uint32_t ioctls;                                        /**< System calls made */
+
+private:
+    MLX90614SimBus* _bus;
+    boolean  _rdwr;                                         /**< Adapter supports I2C_RDWR */
+    int      _slave;
+    boolean  _pecOn;
+
+    static int sysOpen(void* ctx, const char* path);
+    static int sysClose(void* ctx, int fd);
+    static int sysIoctl(void* ctx, int fd, unsigned long req, void* arg);
+    int      ioctl(unsigned long req, void* arg);
+};
+
+#endif /* _MLX90614LINUXBUS_H_ */
@@ -0,0 +1,227 @@
+/***********************************************************************************************//**
+ *  \brief      Melexis MLX90614 Family Device Driver Library - Bus log file and replay (host).
+ *  \file       MLX90614LOG.CPP
+ *  \author     J. F. Fitter <jfitter@eagleairaust.com.au>
+ *  \version    1.0
+ *  \date       2014-2017
+ *  \copyright  Copyright &copy; 2017 John Fitter.  All right reserved.
+ *
+ *  \par        License
+ *              This program is free software; you can redistribute it and/or modify it under
+ *              the terms of the GNU Lesser General Public License as published by the Free
+ *              Software Foundation; either version 2.1 of the License, or (at your option)
+ *              any later version.
+ *  \par
+ *              This Program is distributed in the hope that it will be useful, but WITHOUT ANY
+ *              WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *              PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details
+ *              at http://www.gnu.org/copyleft/gpl.html
+ *  \par
+ *              You should have received a copy of the GNU Lesser General Public License along
+ *              with this library; if not, write to the Free Software Foundation, Inc.,
+ *              51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *//***********************************************************************************************/
+
+#include <stdlib.h>
+#include "MLX90614Log.h"
+
+/**************************************************************************************************/
+/*  Log file sink functions.                                                                      */
+/**************************************************************************************************/
+
+/**
+ *  \brief               Create a log file and write the header.
+ *  \param [in] path     File to create.
+ */
+MLX90614FileSink::MLX90614FileSink(const char* path) {
+    uint8_t hdr[MLX90614LOG_HEADERLEN] = {0};
+
+    memcpy(hdr, MLX90614LOG_MAGIC, 4);
+    hdr[4] = MLX90614LOG_VERSION;
+    hdr[5] = MLX90614_BUSRECLEN;
+    _f = fopen(path, "wb");
+    if(_f) fwrite(hdr, 1, sizeof(hdr), _f);
+}
+
+MLX90614FileSink::~MLX90614FileSink() {close();}
+
+void MLX90614FileSink::write(const uint8_t* rec) {if(_f) fwrite(rec, 1, MLX90614_BUSRECLEN, _f);}
+
+void MLX90614FileSink::close(void) {
+    if(_f) fclose(_f);
+    _f = NULL;
+}
+
+/**************************************************************************************************/
+/*  Replay bus functions.                                                                         */
+/**************************************************************************************************/
+
+/**
+ *  \brief               Replay bus constructor.
+ *  \param [in] timing   Advance the virtual clock to the recorded timestamps.
+ */
+MLX90614ReplayBus::MLX90614ReplayBus(boolean timing) {
+    _data = NULL;
+    _count = 0;
+    _timing = timing;
+    rewind();
+}
+
+MLX90614ReplayBus::~MLX90614ReplayBus() {free(_data);}
+
+/**
+ *  \brief               Load a log file.
+ *  \param [in] path     File written by MLX90614FileSink.
+ *  \return              False if the file cannot be read or is not a bus log.
+ */
+boolean MLX90614ReplayBus::load(const char* path) {
+    uint8_t hdr[MLX90614LOG_HEADERLEN];
+    FILE* f = fopen(path, "rb");
+
+    if(!f) return false;
+    boolean ok = (fread(hdr, 1, sizeof(hdr), f) == sizeof(hdr)) && !memcmp(hdr, MLX90614LOG_MAGIC, 4)
+              && (hdr[4] >= 1) && (hdr[4] <= MLX90614LOG_VERSION);
+    boolean old = ok && (hdr[4] < 3);
+    ok = ok && (hdr[5] == (old ? MLX90614LOG_V2RECLEN : MLX90614_BUSRECLEN));
+    if(ok) {
+        fseek(f, 0, SEEK_END);
+        long len = ftell(f) - MLX90614LOG_HEADERLEN;
+        fseek(f, MLX90614LOG_HEADERLEN, SEEK_SET);
+        uint8_t* data = (uint8_t*)malloc(len > 0 ? len : 1);
+        ok = data && (fread(data, 1, len, f) == (size_t)len);
+        if(ok && old) ok = loadPacked(data, len);
+        else if(ok) ok = load(data, len);
+        free(data);
+    }
+    fclose(f);
+    return ok;
+}
+
+/**
+ *  \brief               Load records from memory (copied).
+ *  \param [in] data     Records, without the file header.
+ *  \param [in] len      Length in bytes, a partial last record is ignored.
+ *  \return              False if out of memory.
+ */
+boolean MLX90614ReplayBus::load(const uint8_t* data, uint32_t len) {
+
+    free(_data);
+    _count = len / MLX90614_BUSRECLEN;
+    _data = (uint8_t*)malloc(_count * MLX90614_BUSRECLEN + 1);
+    if(!_data) _count = 0;
+    else memcpy(_data, data, _count * MLX90614_BUSRECLEN);
+    rewind();
+    return _data != NULL;
+}
+
+/**
+ *  \brief               Load records of log versions 1 and 2, kind and status packed in one byte.
+ *  \remarks             Only the low 4 bits of the status were recorded.
+ *  \param [in] data     Records, without the file header.
+ *  \param [in] len      Length in bytes, a partial last record is ignored.
+ *  \return              False if out of memory.
+ */
+boolean MLX90614ReplayBus::loadPacked(const uint8_t* data, uint32_t len) {
+    uint32_t n = len / MLX90614LOG_V2RECLEN;
+    uint8_t* recs = (uint8_t*)malloc(n * MLX90614_BUSRECLEN + 1);
+
+    if(!recs) return false;
+    for(uint32_t i = 0; i < n; i++) {
+        const uint8_t* src = &data[i * MLX90614LOG_V2RECLEN];
+        uint8_t* dst = &recs[i * MLX90614_BUSRECLEN];
+        memcpy(dst, src, 4);
+        dst[4] = src[4] & MLX90614_RECKIND;
+        dst[5] = src[4] & MLX90614_RECSTATUS;
+        memcpy(dst + 6, src + 5, 5);
+    }
+    boolean ok = load(recs, n * MLX90614_BUSRECLEN);
+    free(recs);
+    return ok;
+}
+
+/**
+ *  \brief               Restart from the first record.
+ */
+void MLX90614ReplayBus::rewind(void) {
+    _pos = 0;
+    _started = false;
+    _inRead = false;
+    mismatches = 0;
+}
+
+/**
+ *  \brief               Take the next record and check it matches the transaction.
+ *  \return              False on a mismatch or at the end of the log.
+ */
+boolean MLX90614ReplayBus::next(uint8_t kind, uint8_t addr, uint8_t cmd) {
+
+    if(_pos >= _count) {
+        ++mismatches;
+        return false;
+    }
+    _rec.unpack(&_data[_pos++ * MLX90614_BUSRECLEN]);
+
+    if(_timing) {
+        if(!_started) {
+            _started = true;
+            _t0 = micros();
+            _ts0 = _rec.timestamp;
+        }
+        uint32_t due = _t0 + (_rec.timestamp - _ts0);
+        if((int32_t)(due - micros()) > 0) hostAdvance(due - micros());
+    }
+    if((_rec.kind != kind) || (_rec.addr != addr) || (_rec.cmd != cmd)) {
+        ++mismatches;
+        return false;
+    }
+    return true;
+}
+
+uint8_t MLX90614ReplayBus::sendCommand(uint8_t addr, uint8_t cmd) {
+
+    _inRead = next(MLX90614_RECREAD, addr, cmd);
+    return _inRead ? _rec.status : MLX90614_TXOTHER;
+}
+
+uint8_t MLX90614ReplayBus::receive(uint8_t addr, uint8_t* buf, uint8_t len) {
+    uint8_t out[3] = {_rec.lo, _rec.hi, _rec.pec};
+
+    if(!_inRead) {
+        memset(buf, 0xff, len);
+        return MLX90614_NORWERROR;
+    }
+    _inRead = false;
+
+    // The data must be fetched from the device the command was sent to.
+    if(addr != _rec.addr) {
+        ++mismatches;
+        memset(buf, 0xff, len);
+        return MLX90614_TXOTHER;
+    }
+    for(uint8_t i = 0; i < len; i++) buf[i] = i < 3 ? out[i] : 0xff;
+    return MLX90614_NORWERROR;
+}
+
+uint8_t MLX90614ReplayBus::transmit(uint8_t addr, const uint8_t* buf, uint8_t len) {
+
+    _inRead = false;
+    if(!next((len == 2) ? MLX90614_RECSEND : MLX90614_RECWRITE, addr, len ? buf[0] : 0xff))
+        return MLX90614_TXOTHER;
+    boolean match = (len == 2) ? (buf[1] == _rec.lo)
+                  : (len == 4) && (buf[1] == _rec.lo) && (buf[2] == _rec.hi) && (buf[3] == _rec.pec);
+    if(!match) {
+        ++mismatches;
+        return MLX90614_TXOTHER;
+    }
+    return _rec.status;
+}
+
+/**
+ *  \brief               Wake line event, true if it was supported when recorded.
+ */
+boolean MLX90614ReplayBus::wakeLine(boolean low) {
+
+    _inRead = false;
+    return next(MLX90614_RECWAKE, 0, low ? 1 : 0) && !_rec.status;
+}
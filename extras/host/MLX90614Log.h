@@ -0,0 +1,110 @@
+#ifndef _MLX90614LOG_H_
+#define _MLX90614LOG_H_
+
+/***********************************************************************************************//**
+ *  \brief      Melexis MLX90614 Family Device Driver Library - Bus log file and replay (host).
+ *  \par
+ *  \par        Details
+ *              MLX90614FileSink writes the records of an MLX90614Recorder to a binary log file.
+ *              MLX90614ReplayBus serves a log back to the driver in place of the devices.
+ *  \li         File: 8 byte header ("MLXB", version, record length, 2 reserved) followed by
+ *              MLX90614_BUSRECLEN byte records.
+ *  \li         Replay returns the recorded data, PEC and status for each transaction, and the
+ *              recorded result of each wake line event, in order.
+ *              A transaction that does not match the next record (kind, address, command,
+ *              write data, or a read fetched from another address than its command went to)
+ *              is counted in mismatches and answered with MLX90614_TXOTHER.
+ *  \li         With timing enabled the virtual clock is advanced to each record's timestamp
+ *              (relative to the first), so every transaction starts at its recorded time. The
+ *              transactions themselves take no time.
+ *  \li         A log can be captured on the target with any sink (eg. an SD card file) as long
+ *              as the same header is written first.
+ *
+ *  \file       MLX90614LOG.H
+ *  \author     J. F. Fitter <jfitter@eagleairaust.com.au>
+ *  \version    1.0
+ *  \date       2014-2017
+ *  \copyright  Copyright &copy; 2017 John Fitter.  All right reserved.
+ *
+ *  \par        License
+ *              This program is free software; you can redistribute it and/or modify it under
+ *              the terms of the GNU Lesser General Public License as published by the Free
+ *              Software Foundation; either version 2.1 of the License, or (at your option)
+ *              any later version.
+ *  \par
+ *              This Program is distributed in the hope that it will be useful, but WITHOUT ANY
+ *              WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *              PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details
+ *              at http://www.gnu.org/copyleft/gpl.html
+ *  \par
+ *              You should have received a copy of the GNU Lesser General Public License along
+ *              with this library; if not, write to the Free Software Foundation, Inc.,
+ *              51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *//***********************************************************************************************/
+
+#include <stdio.h>
+#include "MLX90614Recorder.h"
+
+#define MLX90614LOG_MAGIC       "MLXB"      /**< Log file magic */
+#define MLX90614LOG_VERSION     3           /**< Log file format version (2 adds send byte and
+                                                 wake line records, 3 the full status byte.
+                                                 Versions 1 and 2 logs still load) */
+#define MLX90614LOG_V2RECLEN    10          /**< Record length of log versions 1 and 2 (bytes) */
+#define MLX90614LOG_HEADERLEN   8           /**< Log file header length (bytes) */
+
+/**************************************************************************************************/
+/* Log file sink.                                                                                 */
+/**************************************************************************************************/
+
+class MLX90614FileSink : public MLX90614RecordSink {
+public:
+    MLX90614FileSink(const char* path);
+    ~MLX90614FileSink();
+
+    boolean  isOpen(void) {return _f != NULL;}              /**< File was created */
+    void     write(const uint8_t* rec);
+    void     close(void);
+
+private:
+    FILE*    _f;
+};
+
+/**************************************************************************************************/
+/* Replay bus.                                                                                    */
+/**************************************************************************************************/
+
+class MLX90614ReplayBus : public MLX90614Bus {
+public:
+    MLX90614ReplayBus(boolean timing = true);
+    ~MLX90614ReplayBus();
+
+    boolean  load(const char* path);
+    boolean  load(const uint8_t* data, uint32_t len);       /**< Records only, no header */
+    boolean  loadPacked(const uint8_t* data, uint32_t len); /**< Version 1 and 2 records */
+    void     rewind(void);
+    boolean  done(void) {return _pos >= _count;}            /**< All records replayed */
+    uint32_t count(void) {return _count;}                   /**< Records loaded */
+
+    uint8_t  sendCommand(uint8_t addr, uint8_t cmd);
+    uint8_t  receive(uint8_t addr, uint8_t* buf, uint8_t len);
+    uint8_t  transmit(uint8_t addr, const uint8_t* buf, uint8_t len);
+    boolean  wakeLine(boolean low);
+
+    uint32_t mismatches;                                    /**< Transactions not matching the log */
+
+private:
+    uint8_t* _data;
+    uint32_t _count;
+    uint32_t _pos;                                          /**< Next record */
+    boolean  _timing;
+    boolean  _started;
+    uint32_t _t0;                                           /**< Virtual time of the first record */
+    uint32_t _ts0;                                          /**< Timestamp of the first record */
+    MLX90614BusRecord _rec;                                 /**< Read in progress */
+    boolean  _inRead;
+
+    boolean  next(uint8_t kind, uint8_t addr, uint8_t cmd);
+};
+
+#endif /* _MLX90614LOG_H_ */
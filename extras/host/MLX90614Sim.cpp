@@ -0,0 +1,341 @@
+/***********************************************************************************************//**
+ *  \brief      Melexis MLX90614 Family Device Driver Library - Simulated device and bus (host).
+ *  \file       MLX90614SIM.CPP
+ *  \author     J. F. Fitter <jfitter@eagleairaust.com.au>
+ *  \version    1.0
+ *  \date       2014-2017
+ *  \copyright  Copyright &copy; 2017 John Fitter.  All right reserved.
+ *
+ *  \par        License
+ *              This program is free software; you can redistribute it and/or modify it under
+ *              the terms of the GNU Lesser General Public License as published by the Free
+ *              Software Foundation; either version 2.1 of the License, or (at your option)
+ *              any later version.
+ *  \par
+ *              This Program is distributed in the hope that it will be useful, but WITHOUT ANY
+ *              WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *              PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details
+ *              at http://www.gnu.org/copyleft/gpl.html
+ *  \par
+ *              You should have received a copy of the GNU Lesser General Public License along
+ *              with this library; if not, write to the Free Software Foundation, Inc.,
+ *              51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *//***********************************************************************************************/
+
+#include <chrono>
+#include <thread>
+#include "MLX90614Sim.h"
+
+/**************************************************************************************************/
+/*  Simulated MLX90614 device functions.                                                          */
+/**************************************************************************************************/
+
+/**
+ *  \brief  Factory default EEPROM image of an MLX90614BAA.
+ */
+static const uint16_t simEEDefaults[32] = {
+    0x9993, 0x62E3, 0x0201, 0xF71C, 0xFFFF, 0x9FB4, 0x2DA0, 0x7E2C,
+    0x0000, 0xAE8A, 0x2F7A, 0x1A47, 0x0F99, 0xC9E8, 0xBE5A, 0x0000,
+    0x8B52, 0xB4C5, 0x0B5C, 0x2DE6, 0x00F4, 0x1F28, 0x8C0F, 0x2D87,
+    0x4ACB, 0x0000, 0x6E09, 0x9E0A, 0xB2F1, 0x0E02, 0x3E17, 0x0A8C
+};
+
+/**
+ *  \brief               Simulated device constructor.
+ *  \param [in] i2caddr  Device address programmed into EEPROM.
+ */
+MLX90614SimDevice::MLX90614SimDevice(uint8_t i2caddr) {
+
+    memcpy(_eeprom, simEEDefaults, sizeof(_eeprom));
+    _eeprom[MLX90614_ADDR] = (_eeprom[MLX90614_ADDR] & 0xff00) | (i2caddr & 0x7f);
+    for(uint8_t i = 0; i < 5; i++) _ram[i] = 0;
+    setTemp(MLX90614_TA, 298.15);
+    setTemp(MLX90614_TOBJ1, 310.15);
+    setTemp(MLX90614_TOBJ2, 310.15);
+    _cmd = 0;
+    _fault = MLX90614SIM_NOFAULT;
+    _faultCount = 0;
+    _busy = false;
+    _busyStart = 0;
+    eeTime = MLX90614SIM_TEEWRITE;
+    eeWrites = eeErases = 0;
+    initTime = MLX90614SIM_TINIT;
+    sleeps = sleepTime = 0;
+    _asleep = _init = false;
+    _sleepStart = _initStart = 0;
+    powerCycle();
+}
+
+/**
+ *  \brief  Simulate a power cycle - the slave address is reloaded from EEPROM.
+ */
+void MLX90614SimDevice::powerCycle(void) {_addr = lowByte(_eeprom[MLX90614_ADDR]) & 0x7f;}
+
+void MLX90614SimDevice::setRam(uint8_t reg, uint16_t val) {
+    if((reg >= MLX90614_RAWIR1) && (reg <= MLX90614_TOBJ2)) _ram[reg - MLX90614_RAWIR1] = val;
+}
+
+uint16_t MLX90614SimDevice::getRam(uint8_t reg) {
+    return ((reg >= MLX90614_RAWIR1) && (reg <= MLX90614_TOBJ2)) ? _ram[reg - MLX90614_RAWIR1] : 0;
+}
+
+/**
+ *  \brief             Set a linearized temperature register.
+ *  \param [in] reg    RAM register (MLX90614_TA, MLX90614_TOBJ1 or MLX90614_TOBJ2).
+ *  \param [in] degK   Temperature in &deg;K.
+ */
+void MLX90614SimDevice::setTemp(uint8_t reg, double degK) {setRam(reg, (uint16_t)(degK / 0.02 + 0.5));}
+
+void MLX90614SimDevice::setEEProm(uint8_t reg, uint16_t val) {_eeprom[reg & 0x1f] = val;}
+
+uint16_t MLX90614SimDevice::getEEProm(uint8_t reg) {return _eeprom[reg & 0x1f];}
+
+/**
+ *  \brief  Return the flags register (INIT is low active).
+ */
+uint16_t MLX90614SimDevice::flags(void) {
+    return (eeBusy() ? MLX90614_EEBUSY : 0) | (initializing() ? 0 : MLX90614_INIT);
+}
+
+/**
+ *  \brief  Wake up from sleep mode and start the initialization.
+ */
+void MLX90614SimDevice::wake(void) {
+
+    if(!_asleep) return;
+    _asleep = false;
+    sleepTime += micros() - _sleepStart;
+    _init = true;
+    _initStart = micros();
+}
+
+/**
+ *  \brief  Return true while initializing after wake up.
+ */
+boolean MLX90614SimDevice::initializing(void) {
+    if(_init && ((uint32_t)(micros() - _initStart) >= initTime)) _init = false;
+    return _init;
+}
+
+/**
+ *  \brief             Inject a fault into the next transactions addressed to this device.
+ *  \param [in] fault  Fault type (MLX90614SIM_NACKADDR, MLX90614SIM_NACKDATA, MLX90614SIM_BADPEC).
+ *  \param [in] count  Number of transactions to affect.
+ */
+void MLX90614SimDevice::injectFault(uint8_t fault, uint32_t count) {
+    _fault = fault;
+    _faultCount = count;
+}
+
+/**
+ *  \brief  Return true if an EEPROM erase/write cycle is in progress.
+ */
+boolean MLX90614SimDevice::eeBusy(void) {
+    if(_busy && ((uint32_t)(micros() - _busyStart) >= eeTime)) _busy = false;
+    return _busy;
+}
+
+/**
+ *  \brief             Consume one injected fault of the given type.
+ *  \return            True if the fault applies to this transaction.
+ */
+boolean MLX90614SimDevice::fault(uint8_t type) {
+    if((_fault != type) || !_faultCount) return false;
+    if(!--_faultCount) _fault = MLX90614SIM_NOFAULT;
+    return true;
+}
+
+/**
+ *  \brief             Command phase of a read word transaction.
+ *  \param [in] cmd    Command byte.
+ *  \return            R/W error flags.
+ */
+uint8_t MLX90614SimDevice::command(uint8_t cmd) {
+    if(_asleep) return MLX90614_TXADDRNACK;
+    if(fault(MLX90614SIM_NACKADDR)) return MLX90614_TXADDRNACK;
+    if(fault(MLX90614SIM_NACKDATA)) return MLX90614_TXDATANACK;
+    if(((cmd & 0xe0) == 0x20) && eeBusy()) return MLX90614_TXDATANACK;
+    _cmd = cmd;
+    return MLX90614_NORWERROR;
+}
+
+/**
+ *  \brief                Read phase of a read word transaction.
+ *  \param [in] busaddr   Slave address used on the bus.
+ *  \param [out] buf      Data low byte, high byte and PEC.
+ *  \param [in] len       Number of bytes requested.
+ *  \return               R/W error flags.
+ */
+uint8_t MLX90614SimDevice::respond(uint8_t busaddr, uint8_t* buf, uint8_t len) {
+    uint16_t val;
+    CRC8 crc(MLX90614_CRC8POLY);
+
+    if((_cmd >= MLX90614_RAWIR1) && (_cmd <= MLX90614_TOBJ2)) val = initializing() ? 0 : _ram[_cmd - MLX90614_RAWIR1];
+    else if((_cmd & 0xe0) == 0x20) val = _eeprom[_cmd & 0x1f];
+    else if(_cmd == MLX90614_RFLAGCMD) val = flags();
+    else val = 0xffff;
+
+    crc.crc8(busaddr << 1);
+    crc.crc8(_cmd);
+    crc.crc8((busaddr << 1) + 1);
+    crc.crc8(lowByte(val));
+    uint8_t pec = crc.crc8(highByte(val));
+    if(fault(MLX90614SIM_BADPEC)) pec ^= 0x5a;
+
+    uint8_t out[3] = {lowByte(val), highByte(val), pec};
+    for(uint8_t i = 0; i < len; i++) buf[i] = i < 3 ? out[i] : 0xff;
+    return MLX90614_NORWERROR;
+}
+
+/**
+ *  \brief                Write word transaction.
+ *  \param [in] busaddr   Slave address used on the bus.
+ *  \param [in] buf       Command, data low byte, high byte and PEC.
+ *  \param [in] len       Number of bytes sent.
+ *  \return               R/W error flags.
+ */
+uint8_t MLX90614SimDevice::accept(uint8_t busaddr, const uint8_t* buf, uint8_t len) {
+    CRC8 crc(MLX90614_CRC8POLY);
+
+    if(_asleep) return MLX90614_TXADDRNACK;
+    if(fault(MLX90614SIM_NACKADDR)) return MLX90614_TXADDRNACK;
+    if(fault(MLX90614SIM_NACKDATA)) return MLX90614_TXDATANACK;
+
+    // Sleep command and PEC.
+    crc.crc8(busaddr << 1);
+    if((len == 2) && (buf[0] == MLX90614_SLEEPCMD)) {
+        if(crc.crc8(buf[0]) != buf[1]) return MLX90614_TXDATANACK;
+        _asleep = true;
+        _sleepStart = micros();
+        ++sleeps;
+        return MLX90614_NORWERROR;
+    }
+    if(len != 4) return MLX90614_TXDATANACK;
+
+    // Check the PEC, the device NACKs the last byte on a mismatch.
+    for(uint8_t i = 0; i < 3; i++) crc.crc8(buf[i]);
+    if(crc.crc8() != buf[3]) return MLX90614_TXDATANACK;
+
+    uint8_t cmd = buf[0];
+    if((cmd & 0xe0) != 0x20) return MLX90614_TXDATANACK;
+    if(eeBusy()) return MLX90614_TXDATANACK;
+
+    // Factory calibration words are silently protected.
+    uint8_t reg = cmd & 0x1f;
+    if(!((MLX90614SIM_EEWRITABLE >> reg) & 1)) return MLX90614_NORWERROR;
+
+    uint16_t data = buf[1] | (buf[2] << 8);
+    if(data) {
+        _eeprom[reg] |= data;
+        ++eeWrites;
+    } else {
+        _eeprom[reg] = 0;
+        ++eeErases;
+    }
+    _busy = true;
+    _busyStart = micros();
+    return MLX90614_NORWERROR;
+}
+
+/**************************************************************************************************/
+/*  Simulated SMBus functions.                                                                    */
+/**************************************************************************************************/
+
+/**
+ *  \brief               Simulated bus constructor.
+ *  \param [in] bitrate  SMBus clock frequency in Hz (0 = transactions take no time).
+ */
+MLX90614SimBus::MLX90614SimBus(uint32_t bitrate) {
+    _ndev = 0;
+    _active = NULL;
+    _bitrate = bitrate;
+    _turnaround = MLX90614_XDLY;
+    _latency = 0;
+    _sdaLow = false;
+    _sdaLowStart = 0;
+    transactions = 0;
+}
+
+/**
+ *  \brief               Connect a simulated device to the bus.
+ *  \return              False if the bus is full.
+ */
+boolean MLX90614SimBus::attach(MLX90614SimDevice& dev) {
+    if(_ndev >= MLX90614SIM_MAXDEVICES) return false;
+    _dev[_ndev++] = &dev;
+    return true;
+}
+
+/**
+ *  \brief               Find the device responding to an address (broadcast selects the first).
+ */
+MLX90614SimDevice* MLX90614SimBus::find(uint8_t addr) {
+    if(addr == MLX90614_BROADCASTADDR) return _ndev ? _dev[0] : NULL;
+    for(uint8_t i = 0; i < _ndev; i++) if(_dev[i]->address() == addr) return _dev[i];
+    return NULL;
+}
+
+/**
+ *  \brief               Advance the virtual clock by the time taken to clock bytes on the bus.
+ *  \param [in] nbytes   Number of bytes including the address byte.
+ */
+void MLX90614SimBus::wire(uint8_t nbytes) {
+    if(_bitrate) hostAdvance(((uint32_t)nbytes * 9 + 2) * 1000000UL / _bitrate);
+}
+
+/**
+ *  \brief               Sleep for the real time latency of a transaction (see setLatency()).
+ */
+void MLX90614SimBus::sleep(void) {
+    if(_latency) std::this_thread::sleep_for(std::chrono::microseconds(_latency));
+}
+
+/**
+ *  \brief               Drive SDA low with SCL high. Releasing it after more than
+ *                       MLX90614SIM_TDDQ wakes every sleeping device on the bus.
+ */
+boolean MLX90614SimBus::wakeLine(boolean low) {
+
+    if(low) {
+        _sdaLow = true;
+        _sdaLowStart = micros();
+    } else if(_sdaLow) {
+        _sdaLow = false;
+        if((uint32_t)(micros() - _sdaLowStart) > MLX90614SIM_TDDQ)
+            for(uint8_t i = 0; i < _ndev; i++) _dev[i]->wake();
+    }
+    return true;
+}
+
+uint8_t MLX90614SimBus::sendCommand(uint8_t addr, uint8_t cmd) {
+    wire(2);
+    _active = find(addr);
+    if(!_active) return MLX90614_TXADDRNACK;
+    uint8_t err = _active->command(cmd);
+    if(err) _active = NULL;
+    return err;
+}
+
+uint8_t MLX90614SimBus::receive(uint8_t addr, uint8_t* buf, uint8_t len) {
+    wire(len + 1);
+    sleep();
+    ++transactions;
+    MLX90614SimDevice* dev = _active;
+    _active = NULL;
+    if(!dev || (dev != find(addr))) {
+        memset(buf, 0xff, len);
+        return MLX90614_NORWERROR;
+    }
+    return dev->respond(addr, buf, len);
+}
+
+uint8_t MLX90614SimBus::transmit(uint8_t addr, const uint8_t* buf, uint8_t len) {
+    wire(len + 1);
+    sleep();
+    ++transactions;
+    _active = NULL;
+    MLX90614SimDevice* dev = find(addr);
+    if(!dev) return MLX90614_TXADDRNACK;
+    return dev->accept(addr, buf, len);
+}
@@ -0,0 +1,154 @@
+#ifndef _MLX90614SIM_H_
+#define _MLX90614SIM_H_
+
+/***********************************************************************************************//**
+ *  \brief      Melexis MLX90614 Family Device Driver Library - Simulated device and bus (host).
+ *  \par
+ *  \par        Details
+ *              A software model of one or more MLX90614 devices on an SMBus. It implements the
+ *              MLX90614Bus transport so the unmodified device class can be run, profiled and
+ *              exercised on a host computer.
+ *  \li         RAM 0x04...0x08, EEPROM 0x20...0x3F and the flags register (0xF0) are modelled.
+ *  \li         Every response carries a correct PEC. Writes with a bad PEC are NACKed.
+ *  \li         EEPROM erase/write sets EEBUSY for eeTime microseconds (default
+ *              MLX90614SIM_TEEWRITE).
+ *              EEPROM accesses while busy are NACKed.
+ *  \li         Writing a non-zero word over a non-erased cell corrupts it (bitwise OR).
+ *  \li         The sleep command (with a correct PEC) puts the device to sleep, it then ignores
+ *              the bus until SDA is held low for more than MLX90614SIM_TDDQ. It then initializes for
+ *              initTime microseconds, the INIT flag is 0 and the RAM registers read 0 meanwhile.
+ *  \li         Faults (address NACK, data NACK, bad PEC) can be injected per device.
+ *  \li         Each transaction advances the virtual clock by its time on the wire.
+ *  \li         The bus can also sleep for a real time latency per transaction, to model a slow
+ *              adapter when several buses are driven from separate threads.
+ *
+ *  \file       MLX90614SIM.H
+ *  \author     J. F. Fitter <jfitter@eagleairaust.com.au>
+ *  \version    1.0
+ *  \date       2014-2017
+ *  \copyright  Copyright &copy; 2017 John Fitter.  All right reserved.
+ *
+ *  \par        License
+ *              This program is free software; you can redistribute it and/or modify it under
+ *              the terms of the GNU Lesser General Public License as published by the Free
+ *              Software Foundation; either version 2.1 of the License, or (at your option)
+ *              any later version.
+ *  \par
+ *              This Program is distributed in the hope that it will be useful, but WITHOUT ANY
+ *              WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *              PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details
+ *              at http://www.gnu.org/copyleft/gpl.html
+ *  \par
+ *              You should have received a copy of the GNU Lesser General Public License along
+ *              with this library; if not, write to the Free Software Foundation, Inc.,
+ *              51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *//***********************************************************************************************/
+
+#include "MLX90614.h"
+
+/**************************************************************************************************/
+/* Definitions                                                                                    */
+/**************************************************************************************************/
+
+#define MLX90614SIM_MAXDEVICES  16          /**< Maximum number of devices on a simulated bus */
+#define MLX90614SIM_TEEWRITE    5000        /**< EEPROM erase/write busy time (us) */
+#define MLX90614SIM_TDDQ        33000       /**< Minimum SDA low time to wake up (us) */
+#define MLX90614SIM_TINIT       65000       /**< Initialization time after wake up (us) */
+#define MLX90614SIM_BITRATE     100000      /**< Default simulated SMBus clock (Hz) */
+#define MLX90614SIM_EEWRITABLE  MLX90614_EEWRITABLE /**< Customer writable EEPROM words bitmask */
+
+/** Injectable faults. */
+#define MLX90614SIM_NOFAULT     0           /**< Normal operation */
+#define MLX90614SIM_NACKADDR    1           /**< Next transaction(s) - address not acknowledged */
+#define MLX90614SIM_NACKDATA    2           /**< Next transaction(s) - data not acknowledged */
+#define MLX90614SIM_BADPEC      3           /**< Next read(s) - return a corrupted PEC */
+
+/**************************************************************************************************/
+/* Simulated MLX90614 device.                                                                     */
+/**************************************************************************************************/
+
+class MLX90614SimDevice {
+public:
+    MLX90614SimDevice(uint8_t i2caddr = MLX90614_I2CDEFAULTADDR);
+
+    uint8_t  address(void) {return _addr;}                  /**< Active slave address */
+    void     powerCycle(void);                              /**< Latch the EEPROM address */
+
+    void     setRam(uint8_t reg, uint16_t val);             /**< Set a RAM register (0x04...0x08) */
+    uint16_t getRam(uint8_t reg);                           /**< Get a RAM register (0x04...0x08) */
+    void     setTemp(uint8_t reg, double degK);             /**< Set a temperature register */
+    void     setEEProm(uint8_t reg, uint16_t val);          /**< Set an EEPROM word directly */
+    uint16_t getEEProm(uint8_t reg);                        /**< Get an EEPROM word directly */
+    uint16_t flags(void);                                   /**< Current flags register value */
+
+    void     injectFault(uint8_t fault, uint32_t count = 1);
+    void     wake(void);                                    /**< Wake up condition seen on the bus */
+    boolean  asleep(void) {return _asleep;}                 /**< In sleep mode */
+    boolean  initializing(void);                            /**< Initialization after wake up */
+
+    uint32_t eeTime;                                        /**< EEPROM erase/write busy time (us) */
+    uint32_t eeWrites;                                      /**< EEPROM write cycles (non-zero data) */
+    uint32_t eeErases;                                      /**< EEPROM erase cycles (zero data) */
+    uint32_t initTime;                                      /**< Initialization time after wake up (us) */
+    uint32_t sleeps;                                        /**< Sleep commands accepted */
+    uint32_t sleepTime;                                     /**< Total time asleep (us) */
+
+    uint8_t  command(uint8_t cmd);                          /**< Bus: command phase */
+    uint8_t  respond(uint8_t busaddr, uint8_t* buf, uint8_t len);
+    uint8_t  accept(uint8_t busaddr, const uint8_t* buf, uint8_t len);
+
+private:
+    uint8_t  _addr;
+    uint8_t  _cmd;
+    uint8_t  _fault;
+    uint32_t _faultCount;
+    uint32_t _busyStart;
+    boolean  _busy;
+    boolean  _asleep;
+    uint32_t _sleepStart;
+    uint32_t _initStart;
+    boolean  _init;                                         /**< Initializing after wake up */
+    uint16_t _ram[5];
+    uint16_t _eeprom[32];
+
+    boolean  eeBusy(void);
+    boolean  fault(uint8_t type);
+};
+
+/**************************************************************************************************/
+/* Simulated SMBus.                                                                               */
+/**************************************************************************************************/
+
+class MLX90614SimBus : public MLX90614Bus {
+public:
+    MLX90614SimBus(uint32_t bitrate = MLX90614SIM_BITRATE);
+
+    boolean  attach(MLX90614SimDevice& dev);
+    void     setTurnaround(uint16_t us) {_turnaround = us;}
+    void     setLatency(uint32_t us) {_latency = us;}       /**< Real time sleep per transaction */
+    boolean  wakeLine(boolean low);
+
+    uint8_t  sendCommand(uint8_t addr, uint8_t cmd);
+    uint8_t  receive(uint8_t addr, uint8_t* buf, uint8_t len);
+    uint8_t  transmit(uint8_t addr, const uint8_t* buf, uint8_t len);
+    uint16_t turnaround(void) {return _turnaround;}
+
+    uint32_t transactions;                                  /**< Completed bus transactions */
+
+private:
+    MLX90614SimDevice* _dev[MLX90614SIM_MAXDEVICES];
+    MLX90614SimDevice* _active;
+    uint8_t  _ndev;
+    uint16_t _turnaround;
+    uint32_t _bitrate;
+    uint32_t _latency;                                      /**< Real time sleep per transaction (us) */
+    boolean  _sdaLow;                                       /**< Wake up condition in progress */
+    uint32_t _sdaLowStart;
+
+    MLX90614SimDevice* find(uint8_t addr);
+    void     wire(uint8_t nbytes);
+    void     sleep(void);
+};
+
+#endif /* _MLX90614SIM_H_ */
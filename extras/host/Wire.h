@@ -0,0 +1,50 @@
+#ifndef _HOST_WIRE_H_
+#define _HOST_WIRE_H_
+
+/***********************************************************************************************//**
+ *  \brief      Host (Linux) stand-in for the Arduino Wire library header.
+ *  \par
+ *  \par        Details
+ *              There is no I2C hardware on the host so every transmission is answered with an
+ *              address NACK. Host programs pass a simulated bus to the MLX90614 constructor
+ *              instead of using the default Wire transport.
+ *
+ *  \file       WIRE.H
+ *  \author     J. F. Fitter <jfitter@eagleairaust.com.au>
+ *  \version    1.0
+ *  \date       2014-2017
+ *  \copyright  Copyright &copy; 2017 John Fitter.  All right reserved.
+ *
+ *  \par        License
+ *              This program is free software; you can redistribute it and/or modify it under
+ *              the terms of the GNU Lesser General Public License as published by the Free
+ *              Software Foundation; either version 2.1 of the License, or (at your option)
+ *              any later version.
+ *  \par
+ *              This Program is distributed in the hope that it will be useful, but WITHOUT ANY
+ *              WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *              PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details
+ *              at http://www.gnu.org/copyleft/gpl.html
+ *  \par
+ *              You should have received a copy of the GNU Lesser General Public License along
+ *              with this library; if not, write to the Free Software Foundation, Inc.,
+ *              51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *//***********************************************************************************************/
+
+#include "Arduino.h"
+
+class TwoWire {
+public:
+    void    begin(void)                                 {}
+    void    beginTransmission(uint8_t)                  {}
+    size_t  write(uint8_t)                              {return 1;}
+    uint8_t endTransmission(bool = true)                {return 2;}
+    uint8_t requestFrom(uint8_t, uint8_t)               {return 0;}
+    int     read(void)                                  {return -1;}
+};
+
+inline TwoWire& hostWire(void) {static TwoWire w; return w;}
+#define Wire hostWire()
+
+#endif /* _HOST_WIRE_H_ */
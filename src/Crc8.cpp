@@ -25,6 +25,27 @@
 
 #include "Crc8.h"
 
+/**************************************************************************************************/
+/*  CRC8 lookup tables (default polynomial), generated at compile time.                          */
+/**************************************************************************************************/
+
+#define CRC8_T1(n)      CRC8::crc8Const(n)
+#define CRC8_T4(n)      CRC8_T1(n),      CRC8_T1(n + 1),    CRC8_T1(n + 2),    CRC8_T1(n + 3)
+#define CRC8_T16(n)     CRC8_T4(n),      CRC8_T4(n + 4),    CRC8_T4(n + 8),    CRC8_T4(n + 12)
+#define CRC8_T64(n)     CRC8_T16(n),     CRC8_T16(n + 16),  CRC8_T16(n + 32),  CRC8_T16(n + 48)
+#define CRC8_N1(n)      CRC8::crc8Const((n) << 4, CRC8_DEFAULTPOLY, 4)
+#define CRC8_N4(n)      CRC8_N1(n),      CRC8_N1(n + 1),    CRC8_N1(n + 2),    CRC8_N1(n + 3)
+
+/** CRC of every byte value (256 bytes). */
+static const uint8_t crc8Table[256] CRC8_PROGMEM = {
+    CRC8_T64(0), CRC8_T64(64), CRC8_T64(128), CRC8_T64(192)
+};
+
+/** CRC of every high nibble value after 4 shifts (16 bytes). */
+static const uint8_t crc8Nibble[16] CRC8_PROGMEM = {
+    CRC8_N4(0), CRC8_N4(4), CRC8_N4(8), CRC8_N4(12)
+};
+
 /**************************************************************************************************/
 /*  CRC8 helper class functions.                                                                  */
 /**************************************************************************************************/
@@ -32,8 +53,9 @@
 /**
  *  \brief            CRC8 class constructor.
  *  \param [in] poly  8 bit CRC polynomial to use.
+ *  \param [in] seed  Initial CRC value (eg. a previously saved CRC of a common prefix).
  */
-CRC8::CRC8(uint8_t poly) {crc8Start(poly);}
+CRC8::CRC8(uint8_t poly, uint8_t seed) {crc8Start(poly, seed);}
 
 /**
  *  \brief            Return the current value of the CRC.
@@ -47,19 +69,70 @@ uint8_t CRC8::crc8(void) {return _crc;}
  *  \return           8 bit CRC current value.
  */
 uint8_t CRC8::crc8(uint8_t data) {
-    uint8_t i = 8;
-    
-    _crc ^= data;
-    while(i--) _crc = _crc & 0x80 ? (_crc << 1) ^ _poly : _crc << 1;
+
+    if(_poly != CRC8_DEFAULTPOLY) return _crc = updateBitwise(_crc, data, _poly);
+#ifdef CRC8_NIBBLETABLE
+    return _crc = updateNibble(_crc, data);
+#else
+    return _crc = updateTable(_crc, data);
+#endif
+}
+
+/**
+ *  \brief            Update the current value of the CRC with a block of data.
+ *  \param [in] data  Data to be added to the CRC.
+ *  \param [in] len   Number of bytes.
+ *  \return           8 bit CRC current value.
+ */
+uint8_t CRC8::crc8(const uint8_t* data, size_t len) {
+
+    while(len--) crc8(*data++);
     return _crc;
 }
 
+/**
+ *  \brief            Bitwise CRC update - 8 shifts per byte, no table.
+ *  \param [in] crc   Current CRC.
+ *  \param [in] data  New 8 bit data to be added to the CRC.
+ *  \param [in] poly  8 bit CRC polynomial to use.
+ *  \return           Updated CRC.
+ */
+uint8_t CRC8::updateBitwise(uint8_t crc, uint8_t data, uint8_t poly) {
+    uint8_t i = 8;
+
+    crc ^= data;
+    while(i--) crc = crc & 0x80 ? (crc << 1) ^ poly : crc << 1;
+    return crc;
+}
+
+/**
+ *  \brief            Table CRC update (default polynomial) - 1 lookup per byte, 256 byte table.
+ *  \param [in] crc   Current CRC.
+ *  \param [in] data  New 8 bit data to be added to the CRC.
+ *  \return           Updated CRC.
+ */
+uint8_t CRC8::updateTable(uint8_t crc, uint8_t data) {return CRC8_READ(crc8Table, crc ^ data);}
+
+/**
+ *  \brief            Nibble table CRC update (default polynomial) - 2 lookups per byte, 16 byte table.
+ *  \param [in] crc   Current CRC.
+ *  \param [in] data  New 8 bit data to be added to the CRC.
+ *  \return           Updated CRC.
+ */
+uint8_t CRC8::updateNibble(uint8_t crc, uint8_t data) {
+
+    crc ^= data;
+    crc = (crc << 4) ^ CRC8_READ(crc8Nibble, crc >> 4);
+    return (crc << 4) ^ CRC8_READ(crc8Nibble, crc >> 4);
+}
+
 /**
  *  \brief            Initialize the CRC8 object.
  *  \param [in] poly  8 bit CRC polynomial to use.
+ *  \param [in] seed  Initial CRC value (default 0).
  */
-void CRC8::crc8Start(uint8_t poly) {
+void CRC8::crc8Start(uint8_t poly, uint8_t seed) {
     _poly = poly;
-    _crc = 0;
+    _crc = seed;
 }
 
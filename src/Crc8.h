@@ -34,12 +34,34 @@
 
 #define CRC8_DEFAULTPOLY  7  /**< Default CRC polynomial = X8+X2+X1+1 */
 
+/** The default polynomial uses a lookup table held in flash. Define CRC8_NIBBLETABLE to use a 16
+    entry table (16 bytes, two lookups per byte) instead of the 256 entry table. Other polynomials
+    always use the bitwise algorithm. */
+#if defined(__AVR__)
+    #define CRC8_PROGMEM        PROGMEM
+    #define CRC8_READ(t, i)     pgm_read_byte(&(t)[i])
+#else
+    #define CRC8_PROGMEM
+    #define CRC8_READ(t, i)     ((t)[i])
+#endif
+
 class CRC8 {
 public:
-    CRC8(uint8_t polynomial = CRC8_DEFAULTPOLY);
+    CRC8(uint8_t polynomial = CRC8_DEFAULTPOLY, uint8_t seed = 0);
     uint8_t  crc8(void);
     uint8_t  crc8(uint8_t data);
-    void     crc8Start(uint8_t poly);
+    uint8_t  crc8(const uint8_t* data, size_t len);
+    void     crc8Start(uint8_t poly, uint8_t seed = 0);
+
+    static uint8_t updateBitwise(uint8_t crc, uint8_t data, uint8_t poly = CRC8_DEFAULTPOLY);
+    static uint8_t updateTable(uint8_t crc, uint8_t data);
+    static uint8_t updateNibble(uint8_t crc, uint8_t data);
+
+    /** Compile time CRC of one byte, ie. the table entry for data (bits = number of shifts). */
+    static constexpr uint8_t crc8Const(uint8_t data, uint8_t poly = CRC8_DEFAULTPOLY, uint8_t bits = 8) {
+        return bits ? crc8Const((uint8_t)(data & 0x80 ? (data << 1) ^ poly : data << 1), poly, bits - 1)
+                    : data;
+    }
 private:
     uint8_t  _crc;
     uint8_t  _poly;
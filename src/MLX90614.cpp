@@ -3,8 +3,9 @@
  *  \par
  *  \par        Details
  *              Based on the Melexis MLX90614 Family Data Sheet 3901090614 Rev 004 09jun2008.
- *  \li         The current implementation does not manage PWM (only digital data by I2C).
- *  \li         Sleep mode is not implemented yet.
+ *  \li         PWM output is not read by this class, see MLX90614Pwm (MLX90614Pwm.h).
+ *  \li         Sleep mode needs a transport that can drive SDA low to wake the device (see
+ *              MLX90614Bus::wakeLine()).
  *
  *  \note       THIS IS ONLY A PARTIAL RELEASE. THIS DEVICE CLASS IS CURRENTLY UNDERGOING
  *              ACTIVE DEVELOPMENT AND IS STILL MISSING SOME IMPORTANT FEATURES. PLEASE KEEP 
@@ -46,24 +47,32 @@
 /**
  *  \brief               MLX90614 Device class constructor.
  *  \param [in] i2caddr  Device address (default: published value).
+ *  \param [in] bus      Bus transport (default: Wire library).
  */
-MLX90614::MLX90614(uint8_t i2caddr) {
+MLX90614::MLX90614(uint8_t i2caddr, MLX90614Bus* bus) {
 
-    busAddr.Set_Class(this);
-    busAddr.Set_Get(&MLX90614::getAddr);
-    busAddr.Set_Set(&MLX90614::setAddr);
-
-    rwError.Set_Class(this);
-    rwError.Set_Get(&MLX90614::getRwError);
-
-    pec.Set_Class(this);
-    pec.Set_Get(&MLX90614::getPEC);
-
-    crc8.Set_Class(this);
-    crc8.Set_Get(&MLX90614::getCRC8);
-
-    _addr = i2caddr;
+    _bus = bus;
+    setBusAddr(i2caddr);
     _ready = false;
+    _pending = false;
+    _asyncRaw = 0;
+    _asyncErr = 0;
+    _eeStep = 0;
+    _eeNoFlags = false;
+    _retry.attempts = 1;
+    _retry.retryOn = MLX90614_RETRYON;
+    _retry.backoff = 0;
+    _retry.deadline = 0;
+    _attempts = 0;
+#if MLX90614_THROTTLE
+    _thrOn = false;
+    _thrValid = 0;
+    _thrAge = _thrAvoided = 0;
+#endif
+    invalidate();
+#if MLX90614_STATS
+    resetStats();
+#endif
 }
 
 /**
@@ -88,22 +97,143 @@ boolean MLX90614::begin(void) {
  *  \return            Temperature.
  */
 double MLX90614::readTemp(tempSrc_t tsrc, tempUnit_t tunit) {
-    double temp;
 
     _rwError = 0;
-    switch(tsrc) {
-        case MLX90614_SRC01 : temp = read16(MLX90614_TOBJ1); break;
-        case MLX90614_SRC02 : temp = read16(MLX90614_TOBJ2); break;
-        default : temp = read16(MLX90614_TA);
-    }
-    temp *= 0.02;
+    return rawToTemp(read16(srcReg(tsrc)), tunit);
+}
+
+/**
+ *  \brief             Return a temperature in hundredths of a degree using integer arithmetic only.
+ *  \remarks           Same read as readTemp(), avoiding floating point on small processors.
+ *  \n                 eg. 2315 = 23.15&deg;C
+ *  \param [in] tsrc   Internal temperature source to read, default #1.
+ *  \param [in] tunit  Temperature units to convert raw data to, default &deg;C.
+ *  \return            Temperature in centi-degrees.
+ */
+int32_t MLX90614::readTempFixed(tempSrc_t tsrc, tempUnit_t tunit) {
+
+    _rwError = 0;
+    return rawToFixed(read16(srcReg(tsrc)), tunit);
+}
+
+/**
+ *  \brief             Convert a raw temperature register value to hundredths of a degree.
+ *  \remarks           &deg;K and &deg;C are exact (0.02&deg;K = 2 centi-degrees). &deg;F is
+ *                     rounded to the nearest hundredth.
+ *  \param [in] raw    Register value, resolution 0.02&deg;K.
+ *  \param [in] tunit  Temperature units to convert raw data to, default &deg;C.
+ *  \return            Temperature in centi-degrees.
+ */
+int32_t MLX90614::rawToFixed(uint16_t raw, tempUnit_t tunit) {
+
     switch(tunit) {
-        case MLX90614_TC : return convKtoC(temp);
-        case MLX90614_TF : return convCtoF(convKtoC(temp));  // fix 13feb2020
+        case MLX90614_TC : return centiKtoC(rawToCentiK(raw));
+        case MLX90614_TF : return centiCtoF(centiKtoC(rawToCentiK(raw)));
+        default : return rawToCentiK(raw);
     }
-    return temp;
 }
 
+/**
+ *  \brief             Start an asynchronous temperature read.
+ *  \remarks
+ *  \li                Sends the command and returns without waiting. Call poll() until it
+ *                     returns MLX90614_DONE, then fetch the value with result().
+ *  \li                The result is identical to readTemp() with the same arguments.
+ *  \li                No other transaction may be issued to ANY device on the same bus until
+ *                     poll() returns MLX90614_DONE. The command is sent without a stop condition
+ *                     (Wire.endTransmission(false)) so the bus stays held by this read, another
+ *                     device's transaction would be sent inside it.
+ *  \li                The retry policy does not apply, a failed read is restarted by the caller.
+ *  \param [in] tsrc   Internal temperature source to read, default #1.
+ *  \param [in] tunit  Temperature units to convert raw data to, default &deg;C.
+ *  \return            False if a read is already in progress.
+ */
+boolean MLX90614::startRead(tempSrc_t tsrc, tempUnit_t tunit) {
+
+    if(!startReadRaw(srcReg(tsrc))) return false;
+    _asyncUnit = tunit;
+    return true;
+}
+
+/**
+ *  \brief             Start an asynchronous read of a 16 bit value from RAM or EEPROM.
+ *  \remarks           As startRead(), the bus is held until poll() returns MLX90614_DONE.
+ *  \param [in] cmd    Command to send (register to read from).
+ *  \return            False if a read is already in progress.
+ */
+boolean MLX90614::startReadRaw(uint8_t cmd) {
+
+    if(_pending) return false;
+    _rwError = 0;
+    readStart(cmd);
+    _asyncErr = _rwError;
+    _asyncCmd = cmd;
+    _asyncUnit = MLX90614_TK;
+    _asyncT0 = micros();
+    return _pending = true;
+}
+
+/**
+ *  \brief             Advance an asynchronous read.
+ *  \remarks           The turnaround delay is timed against micros() instead of spinning. Once
+ *                     it has elapsed the data is fetched, the PEC checked, and the R/W error flags
+ *                     property set for the read.
+ *  \return            MLX90614_PENDING, MLX90614_DONE (once per read) or MLX90614_IDLE.
+ */
+MLX90614::pollStat_t MLX90614::poll(void) {
+
+    if(!_pending) return MLX90614_IDLE;
+    if((uint32_t)(micros() - _asyncT0) < _bus->turnaround()) return MLX90614_PENDING;
+
+    _rwError = _asyncErr;
+    _asyncRaw = readFinish(_asyncCmd);
+    _asyncErr = _rwError;
+#if MLX90614_STATS
+    statTx(_asyncCmd, _rwError, _asyncT0);
+#endif
+    _pending = false;
+    return MLX90614_DONE;
+}
+
+/**
+ *  \brief             Read a set of RAM registers back to back into a snapshot.
+ *  \remarks
+ *  \li                Registers are read in address order in one tight sequence.
+ *  \li                Errors are recorded per channel and are not lost when the next channel is
+ *                     read. The R/W error flags property holds all of them OR'ed together.
+ *  \li                Temperatures are left raw, use rawToTemp() to convert only what is needed.
+ *  \li                Each channel is retried according to the retry policy, attempts() returns
+ *                     the total for all channels (saturating at 255).
+ *  \param [out] snap  Snapshot to receive the values and error flags.
+ *  \param [in] mask   Channels to read (MLX90614_CH* bitmask), default all.
+ *  \return            R/W error flags of all channels OR'ed together.
+ */
+uint8_t MLX90614::readAll(snapshot_t& snap, uint8_t mask) {
+    uint8_t  err = 0;
+    uint16_t tries = 0;
+
+    snap.mask = mask &= MLX90614_CHALL;
+    snap.errMask = 0;
+    for(uint8_t i = 0; i < 5; i++, mask >>= 1) {
+        if(!(mask & 1)) continue;
+        _rwError = 0;
+        snap.raw[i] = read16(MLX90614_RAWIR1 + i);
+        if((snap.error[i] = _rwError)) snap.errMask |= 1 << i;
+        err |= _rwError;
+        tries += _attempts;
+    }
+    _attempts = (tries > 0xff) ? 0xff : tries;
+    return _rwError = err;
+}
+
+/**
+ *  \brief             Convert a raw temperature register value to the specified units.
+ *  \param [in] raw    Register value, resolution 0.02&deg;K.
+ *  \param [in] tunit  Temperature units to convert raw data to, default &deg;C.
+ *  \return            Temperature.
+ */
+double MLX90614::rawToTemp(uint16_t raw, tempUnit_t tunit) {return convKto(rawToK(raw), tunit);}
+
 /**
  *  \brief             Set the emissivity (&epsilon;) of the object.
  *  \remarks           The emissivity is stored as a 16 bit integer defined by the following:
@@ -126,6 +256,7 @@ void MLX90614::setEmissivity(float emiss) {
 float MLX90614::getEmissivity(void) {
 
     _rwError = 0;
+    uint16_t emiss = eeCached(MLX90614_EMISS);
     if(_rwError) return (float)1.0;
     return (float)emiss / 65535.0;
 }
@@ -153,7 +284,7 @@ void MLX90614::setIIRcoeff(uint8_t csb) {
     csb &= 7;
 
     // Get the current value of ConfigRegister1
-    uint16_t reg = readEEProm(MLX90614_CONFIG);
+    uint16_t reg = eeCached(MLX90614_CONFIG);
 
     // Clear bits 2:0, mask in the new value, then write it back.
     if(!_rwError) {
@@ -173,7 +304,7 @@ uint8_t MLX90614::getIIRcoeff(void) {
     _rwError = 0;
 
     // Get the current value of ConfigRegister1 bits 2:0
-    uint8_t iir = readEEProm(MLX90614_CONFIG) & 7;
+    uint8_t iir = eeCached(MLX90614_CONFIG) & 7;
 
     if(_rwError) return 4;
     return iir;
@@ -194,7 +325,7 @@ void MLX90614::setFIRcoeff(uint8_t csb) {
     csb &= 7;
 
     // Get the current value of ConfigRegister1
-    uint16_t reg = readEEProm(MLX90614_CONFIG);
+    uint16_t reg = eeCached(MLX90614_CONFIG);
 
     // Clear bits 10:8, mask in the new value, then write it back.
     if(!_rwError) {
@@ -215,12 +346,140 @@ uint8_t MLX90614::getFIRcoeff(void) {
     _rwError = 0;
 
     // Get the current value of ConfigRegister1 bits 10:8
-    uint8_t fir = (readEEProm(MLX90614_CONFIG) >> 8) & 7;
+    uint8_t fir = (eeCached(MLX90614_CONFIG) >> 8) & 7;
 
     if(_rwError) return 7;
     return fir;
 }
 
+/**
+ *  \brief            Return the period at which the device refreshes the temperature registers.
+ *  \remarks
+ *  \li               Derived from the FIR coefficient N and the single/dual IR sensor bit of
+ *                    ConfigRegister1 (served from the EEPROM shadow). The conversion time scales
+ *                    with N and a dual sensor device converts both sources in turn.
+ *  \li               The IIR filter changes the settling time but not the refresh period.
+ *  \return           Approximate refresh period in microseconds.
+ */
+uint32_t MLX90614::dataPeriod(void) {
+    uint8_t err = _rwError;
+
+    _rwError = 0;
+    uint16_t reg = eeCached(MLX90614_CONFIG);
+    uint32_t period = _rwError ? MLX90614_TCONV1024 : periodOf(reg);
+    _rwError = err;
+    return period;
+}
+
+/**
+ *  \brief            Return the refresh period for a ConfigRegister1 value, see dataPeriod().
+ *  \param [in] reg   ConfigRegister1.
+ *  \return           Approximate refresh period in microseconds.
+ */
+uint32_t MLX90614::periodOf(uint16_t reg) {
+    uint32_t period = MLX90614_TCONV1024 >> (7 - ((reg >> 8) & 7));
+
+    return (reg & 0x0040) ? period << 1 : period;
+}
+
+/**
+ *  \brief            Start a configuration transaction.
+ *  \remarks          Changes to the IIR and FIR filters, gain and emissivity are staged in the
+ *                    returned object and written by commit(). Each affected register gets at most
+ *                    one erase/write cycle, and none if its final value is unchanged.
+ *  \n <tt> mlx.beginConfig().setIIRcoeff(5).setFIRcoeff(7).commit(); </tt>
+ *  \return           Configuration transaction object.
+ */
+MLX90614::config_t MLX90614::beginConfig(void) {
+    config_t cfg;
+
+    cfg._dev = this;
+    cfg._mask = cfg._bits = cfg._emiss = 0;
+    cfg._emissSet = false;
+    cfg._err = 0;
+    return cfg;
+}
+
+/**
+ *  \brief            Stage a change of ConfigRegister1 bits.
+ *  \param [in] mask  Bits to change.
+ *  \param [in] bits  New values of the bits.
+ */
+void MLX90614::config_t::stageConfig(uint16_t mask, uint16_t bits) {
+    _mask |= mask;
+    _bits = (_bits & ~mask) | (bits & mask);
+}
+
+/**
+ *  \brief            Stage the IIR filter coefficients (ConfigRegister1 bits 2:0).
+ *  \param [in] csb   Range 0...7, see MLX90614::setIIRcoeff().
+ *  \return           This transaction.
+ */
+MLX90614::config_t& MLX90614::config_t::setIIRcoeff(uint8_t csb) {
+    stageConfig(0x0007, csb & 7);
+    return *this;
+}
+
+/**
+ *  \brief            Stage the FIR filter coefficient (ConfigRegister1 bits 10:8).
+ *  \param [in] csb   Range 0...7, see MLX90614::setFIRcoeff().
+ *  \return           This transaction.
+ */
+MLX90614::config_t& MLX90614::config_t::setFIRcoeff(uint8_t csb) {
+    stageConfig(0x0700, (uint16_t)(csb & 7) << 8);
+    return *this;
+}
+
+/**
+ *  \brief            Stage the amplifier gain (ConfigRegister1 bits 13:11).
+ *  \param [in] csb   Range 0...7. See page 12 of datasheet.
+ *  \return           This transaction.
+ */
+MLX90614::config_t& MLX90614::config_t::setGain(uint8_t csb) {
+    stageConfig(0x3800, (uint16_t)(csb & 7) << 11);
+    return *this;
+}
+
+/**
+ *  \brief             Stage the emissivity.
+ *  \param [in] emiss  Physical emissivity value in range 0.1 ...1.0
+ *  \return            This transaction. An illegal value sets MLX90614_INVALIDATA and the
+ *                     commit will not write anything.
+ */
+MLX90614::config_t& MLX90614::config_t::setEmissivity(float emiss) {
+    uint16_t e = emiss * 65535. + 0.5;
+
+    if((emiss > 1.0) || (e < 6553)) _err |= MLX90614_INVALIDATA;
+    else {
+        _emiss = e;
+        _emissSet = true;
+    }
+    return *this;
+}
+
+/**
+ *  \brief            Write the staged configuration.
+ *  \remarks          The final value of each register is computed from the EEPROM shadow and
+ *                    written only if it differs.
+ *  \return           R/W error flags (also available from the R/W error flags property).
+ */
+uint8_t MLX90614::config_t::commit(void) {
+    MLX90614& dev = *_dev;
+
+    dev._rwError = _err;
+    if(_err) return _err;
+
+    if(_mask) {
+        uint16_t reg = dev.eeCached(MLX90614_CONFIG);
+        if(!dev._rwError) dev.writeEEProm(MLX90614_CONFIG, (reg & ~_mask) | _bits);
+    }
+    if(_emissSet && !dev._rwError) dev.writeEEProm(MLX90614_EMISS, _emiss);
+
+    _mask = 0;
+    _emissSet = false;
+    return dev._rwError;
+}
+
 /**
  *  \brief            Set device SMBus address.
  *  \remarks
@@ -235,12 +494,12 @@ void MLX90614::setAddr(uint8_t addr) {
     // It is assumed we do not know the existing slave address so the broadcast address is used.
     // First ensure the new address is in the legal range (1..127)
     if(addr &= 0x7f) {
-        _addr = MLX90614_BROADCASTADDR;
+        setBusAddr(MLX90614_BROADCASTADDR);
         writeEEProm(MLX90614_ADDR, addr);
         
         // There will always be a r/w error using the broadcast address so we cannot respond
         // to r/w errors. We must just assume this worked.
-        _addr = addr;
+        setBusAddr(addr);
         
     } else _rwError |= MLX90614_INVALIDATA;
 }
@@ -259,56 +518,190 @@ uint8_t MLX90614::getAddr(void) {
 
     // It is assumed we do not know the existing slave address so the broadcast address is used.
     // This will throw a r/w error so errors will be ignored.
-    _addr = MLX90614_BROADCASTADDR;
+    setBusAddr(MLX90614_BROADCASTADDR);
 
     // Reload program copy with the existing slave address.
-    _addr = lowByte(readEEProm(MLX90614_ADDR));
+    setBusAddr(lowByte(readEEProm(MLX90614_ADDR)));
 
     return _addr;
 }
 
+/**
+ *  \brief            Return the RAM register holding a temperature source.
+ *  \param [in] tsrc  Internal temperature source.
+ *  \return           RAM register address.
+ */
+uint8_t MLX90614::srcReg(tempSrc_t tsrc) {
+
+    switch(tsrc) {
+        case MLX90614_SRC01 : return MLX90614_TOBJ1;
+        case MLX90614_SRC02 : return MLX90614_TOBJ2;
+        default : return MLX90614_TA;
+    }
+}
+
+/**
+ *  \brief            Set the slave address used by the library and rebuild the cached CRCs.
+ *  \remarks          The PEC of every transaction starts with the same header bytes for a given
+ *                    address and command, so the CRC state after the header is precomputed.
+ *  \li               Write: <tt>addr<<1</tt>
+ *  \li               Read:  <tt>addr<<1, cmd, (addr<<1)+1</tt> for each RAM register.
+ *  \param [in] addr  Slave address.
+ */
+void MLX90614::setBusAddr(uint8_t addr) {
+    CRC8 crc(MLX90614_CRC8POLY);
+
+    _addr = addr;
+    invalidate();
+    _crcWr = crc.crc8(addr << 1);
+    for(uint8_t i = 0; i < 5; i++) {
+        crc.crc8Start(MLX90614_CRC8POLY, _crcWr);
+        crc.crc8(MLX90614_RAWIR1 + i);
+        _crcRd[i] = crc.crc8((addr << 1) + 1);
+    }
+}
+
+/**
+ *  \brief            Return the CRC of the read header bytes for a command.
+ *  \remarks          Cached for the RAM registers, otherwise 2 updates from the cached address CRC.
+ *  \param [in] cmd   Command (register to read from).
+ *  \return           CRC-8 of <tt>addr<<1, cmd, (addr<<1)+1</tt>.
+ */
+uint8_t MLX90614::readPrefix(uint8_t cmd) {
+
+    if((uint8_t)(cmd - MLX90614_RAWIR1) < 5) return _crcRd[cmd - MLX90614_RAWIR1];
+    CRC8 crc(MLX90614_CRC8POLY, _crcWr);
+    crc.crc8(cmd);
+    return crc.crc8((_addr << 1) + 1);
+}
+
 /**
  *  \brief            Return a 16 bit value read from RAM or EEPROM.
+ *  \remarks          The read is repeated according to the retry policy (see setRetry()) while it
+ *                    fails with a retryable error. The R/W error flags are those of the last
+ *                    attempt, the number of attempts is returned by attempts(). With a deadline
+ *                    a retry is only started if it is expected to end in time, taking the
+ *                    previous attempt as the transaction time.
  *  \param [in] cmd   Command to send (register to read from).
  *  \return           Value read from memory.
  */
 uint16_t MLX90614::read16(uint8_t cmd) {
+    uint8_t  err = _rwError;
+    uint32_t t0 = _retry.deadline ? micros() : 0;
+    uint32_t tx = t0;
     uint16_t val;
-    CRC8 crc(MLX90614_CRC8POLY);
-
-    // Send the slave address then the command and set any error status bits returned by the write.
-    Wire.beginTransmission(_addr);
-    Wire.write(cmd);
-    _rwError |= (1 << Wire.endTransmission(false)) >> 1;
 
-    // Experimentally determined delay to prevent read errors (manufacturer's data sheet has 
-    // left something out).
-    delayMicroseconds(MLX90614_XDLY);
+#if MLX90614_THROTTLE
+    uint8_t slot = cmd - MLX90614_RAWIR1;
+    if(slot >= 5) slot = 0xff;
+    else if(_thrOn && (_thrValid & (1 << slot))) {
+        // The period is only cached once ConfigRegister1 has been read, until then no throttling.
+        if(!_thrPeriod) {
+            _rwError = 0;
+            uint16_t reg = eeCached(MLX90614_CONFIG);
+            if(!_rwError) _thrPeriod = periodOf(reg);
+            _rwError = err;
+        }
+        uint32_t age = micros() - _thrTime[slot];
+        if(age < _thrPeriod) {
+            _attempts = 0;
+            _thrAge = age;
+            ++_thrAvoided;
+            return _thrRaw[slot];
+        }
+    }
+#endif
+
+    for(_attempts = 1;; _attempts++) {
+        _rwError = 0;
+        val = readOnce(cmd);
+        if(!(_rwError & _retry.retryOn) || (_attempts >= _retry.attempts)) break;
+        if(_retry.deadline) {
+            uint32_t now = micros();
+            if((uint32_t)(now - t0) + _retry.backoff + (uint32_t)(now - tx) > _retry.deadline) break;
+            tx = now + _retry.backoff;
+        }
+        if(_retry.backoff) delayMicroseconds(_retry.backoff);
+#if MLX90614_STATS
+        ++_stats.retries;
+#endif
+    }
+#if MLX90614_THROTTLE
+    if(slot != 0xff) {
+        _thrAge = 0;
+        if(_rwError) _thrValid &= ~(1 << slot);
+        else {
+            _thrRaw[slot] = val;
+            _thrTime[slot] = micros();
+            _thrValid |= 1 << slot;
+        }
+    }
+#endif
+    // Earlier r/w errors are kept, except with the broadcast address which clears them.
+    if(_addr != MLX90614_BROADCASTADDR) _rwError |= err;
+    return val;
+}
 
-    // Resend slave address then get the 3 returned bytes.
-    Wire.requestFrom(_addr, (uint8_t)3);
+#if MLX90614_THROTTLE
+/**
+ *  \brief            Enable or disable read throttling.
+ *  \remarks
+ *  \li               The device only refreshes its RAM registers once per dataPeriod(), set by
+ *                    the FIR coefficient (ConfigRegister1, from the EEPROM shadow). While
+ *                    throttling, a RAM register read less than one period after the last good
+ *                    read of the same register returns the cached value without a bus
+ *                    transaction, sampleAge() then gives its age. A fresh read gives age 0.
+ *  \li               A cached value is at most one period older than the device data, which
+ *                    itself lags the sensor by the IIR/FIR settling time.
+ *  \li               Applies to readTemp(), readTempFixed() and readAll(). Asynchronous reads
+ *                    always go to the bus.
+ *  \li               Changing the configuration through the driver updates the period. Until
+ *                    ConfigRegister1 has been read successfully every read goes to the bus.
+ *  \li               Only built with MLX90614_THROTTLE = 1 (MLX90614Config.h).
+ *  \param [in] on    True to enable, false to always read the device (default).
+ */
+void MLX90614::setThrottle(boolean on) {
 
-    // Data is returned as 2 bytes little endian.
-    val = Wire.read();
-    val |= Wire.read() << 8;
+    _thrOn = on;
+    _thrValid = 0;
+    _thrPeriod = 0;
+}
+#endif
 
-    // Rread the PEC (CRC-8 of all bytes).
-    _pec = Wire.read();
+/**
+ *  \brief            Single read transaction, the R/W error flags must be clear on entry.
+ *  \param [in] cmd   Command to send (register to read from).
+ *  \return           Value read from memory.
+ */
+uint16_t MLX90614::readOnce(uint8_t cmd) {
+#if MLX90614_STATS
+    uint32_t t0 = micros();
+#endif
+
+    uint16_t val = readWord(_bus, _addr, cmd, readPrefix(cmd), _rwError, _pec, _crc8);
+#if MLX90614_STATS
+    statTx(cmd, _rwError, t0);
+#endif
+    return val;
+}
 
-    // Clear r/w errors if using broadcast address.
-    if(_addr == MLX90614_BROADCASTADDR) _rwError &= MLX90614_NORWERROR;
-    
-    // Build our own CRC-8 of all received bytes.
-    crc.crc8(_addr << 1);
-    crc.crc8(cmd);
-    crc.crc8((_addr << 1) + 1);
-    crc.crc8(lowByte(val));
-    _crc8 = crc.crc8(highByte(val));
+/**
+ *  \brief            First half of a read - send the command.
+ *  \param [in] cmd   Command to send (register to read from).
+ */
+void MLX90614::readStart(uint8_t cmd) {
 
-    // Set error status bit if CRC mismatch.
-    if(_crc8 != _pec) _rwError |= MLX90614_RXCRC;
+    // Send the slave address then the command and set any error status bits returned by the write.
+    _rwError |= _bus->sendCommand(_addr, cmd);
+}
 
-    return val;
+/**
+ *  \brief            Second half of a read - fetch the data and check the PEC.
+ *  \param [in] cmd   Command that was sent.
+ *  \return           Value read from memory.
+ */
+uint16_t MLX90614::readFinish(uint8_t cmd) {
+    return fetchWord(_bus, _addr, readPrefix(cmd), _rwError, _pec, _crc8);
 }
 
 /**
@@ -317,28 +710,27 @@ uint16_t MLX90614::read16(uint8_t cmd) {
  *  \param [in] data  Value to write.
  */
 void MLX90614::write16(uint8_t cmd, uint16_t data) {
-    CRC8 crc(MLX90614_CRC8POLY);
+    CRC8 crc(MLX90614_CRC8POLY, _crcWr);
+#if MLX90614_STATS
+    uint32_t t0 = micros();
+#endif
 
-    // Build the CRC-8 of all bytes to be sent.
-    crc.crc8(_addr << 1);
+    // Build the CRC-8 of all bytes to be sent, starting from the cached CRC of the address byte.
     crc.crc8(cmd);
     crc.crc8(lowByte(data));
     _crc8 = crc.crc8(highByte(data));
 
-    // Send the slave address then the command.
-    Wire.beginTransmission(_addr);
-    Wire.write(cmd);
-
-    // Write the data low byte first.
-    Wire.write(lowByte(data));
-    Wire.write(highByte(data));
-
-    // Then write the crc and set the r/w error status bits.
-    Wire.write(_pec = _crc8);
-    _rwError |= (1 << Wire.endTransmission(true)) >> 1;
+    // Send the slave address, the command, the data low byte first, then the crc, and set the
+    // r/w error status bits.
+    uint8_t buf[4] = {cmd, lowByte(data), highByte(data), _pec = _crc8};
+    uint8_t err = _bus->transmit(_addr, buf, 4);
 
     // Clear r/w errors if using broadcast address.
-    if(_addr == MLX90614_BROADCASTADDR) _rwError &= MLX90614_NORWERROR;
+    if(_addr == MLX90614_BROADCASTADDR) _rwError = err = MLX90614_NORWERROR;
+#if MLX90614_STATS
+    statTx(cmd, err, t0);
+#endif
+    _rwError |= err;
 }
 
 /**
@@ -351,47 +743,390 @@ uint16_t MLX90614::readEEProm(uint8_t addr) {return read16(addr | 0x20);}
 /**
  *  \brief            Write a 16 bit value to EEPROM after first clearing the memory.
  *  \remarks
- *  \li               Erase and write time 5ms per manufacturer specification
- *  \li               Manufacturer does not specify max or min erase/write times
+ *  \li               Blocking wrapper around eeStart() and eePoll().
+ *  \li               Erase and write time 5ms per manufacturer specification, but the EEBUSY
+ *                    flag is polled so the write finishes as soon as the device is idle.
  *  \param [in] reg   Address to write to.
  *  \param [in] data  Value to write.
  */
 void MLX90614::writeEEProm(uint8_t reg, uint16_t data) {
+    uint8_t err = _rwError;
+
+    if(!eeStart(reg, data)) {
+        _rwError |= MLX90614_INVALIDATA;
+        return;
+    }
+    while(eePoll() == MLX90614_PENDING);
+    _rwError |= err;
+}
+
+/** EEPROM write steps. */
+enum {EE_IDLE, EE_READ, EE_ERASE, EE_ERASEWAIT, EE_WRITE, EE_WRITEWAIT, EE_VERIFY};
+
+/**
+ *  \brief            Start a non-blocking write of a 16 bit value to EEPROM.
+ *  \remarks          Call eePoll() until it returns MLX90614_DONE. The write goes through the
+ *                    steps read/compare, erase, busy wait, write, busy wait, verify. Each call
+ *                    to eePoll() performs at most one bus transaction.
+ *  \param [in] reg   Address to write to.
+ *  \param [in] data  Value to write.
+ *  \return           False if a write is already in progress.
+ */
+boolean MLX90614::eeStart(uint8_t reg, uint16_t data) {
+
+    if(_eeStep != EE_IDLE) return false;
+    _eeReg = reg | 0x20;
+    _eeData = data;
+    _eeErr = 0;
+    _eeNoFlags = false;
+    _eeStep = EE_READ;
+    return true;
+}
+
+/**
+ *  \brief            Advance a non-blocking EEPROM write.
+ *  \remarks
+ *  \li               Nothing is written if the word already holds the value, or if it cannot
+ *                    be read.
+ *  \li               On any R/W errors during the erase or write, or if the value read back does
+ *                    not match, it is assumed the memory is corrupted (MLX90614_EECORRUPT).
+ *  \li               On completion the R/W error flags property holds the result of the write.
+ *  \return           MLX90614_PENDING, MLX90614_DONE (once per write) or MLX90614_IDLE.
+ */
+MLX90614::pollStat_t MLX90614::eePoll(void) {
     uint16_t val;
-    reg |= 0x20;
-
-    // Read current value, compare to the new value, and do nothing on a match or if there are
-    // read errors set the error status flag only.
-    val = read16(reg);
-    if((val != data) && !_rwError) {
-
-        // On any R/W errors it is assumed the memory is corrupted.
-        // Clear the memory and wait Terase (per manufacturer's documentation).
-        write16(reg, 0);
-        delay(5);
-        if(_rwError) _rwError |= MLX90614_EECORRUPT;
-
-        // Write the data and wait Twrite (per manufacturer's documentation) 
-        // and set the r/w error status bits.
-        write16(reg, data); 
-        delay(5);
-        if(_rwError) _rwError |= MLX90614_EECORRUPT;
+
+    // Idle polls leave the R/W error flags of the last read or write alone.
+    if(_eeStep == EE_IDLE) return MLX90614_IDLE;
+
+    _rwError = 0;
+    switch(_eeStep) {
+
+        // Read current value, compare to the new value, and do nothing on a match or if there
+        // are read errors set the error status flag only.
+        case EE_READ :
+            val = eeCached(_eeReg);
+            _eeErr |= _rwError;
+            _eeStep = ((val != _eeData) && !_rwError) ? EE_ERASE : EE_IDLE;
+            break;
+
+        // Clear the memory and wait Terase.
+        case EE_ERASE :
+            write16(_eeReg, 0);
+            if(_rwError) _eeErr |= _rwError | MLX90614_EECORRUPT;
+            _eeT0 = micros();
+            _eeStep = EE_ERASEWAIT;
+            break;
+
+        // Write the data and wait Twrite.
+        case EE_WRITE :
+            write16(_eeReg, _eeData);
+            if(_rwError) _eeErr |= _rwError | MLX90614_EECORRUPT;
+            _eeT0 = micros();
+            _eeStep = EE_WRITEWAIT;
+            break;
+
+        case EE_ERASEWAIT :
+        case EE_WRITEWAIT :
+            if(eeReady()) ++_eeStep;
+            break;
+
+        // Read back and compare.
+        case EE_VERIFY :
+            val = read16(_eeReg);
+            if(_rwError || (val != _eeData)) _eeErr |= _rwError | MLX90614_EECORRUPT;
+            _eeStep = EE_IDLE;
+            break;
     }
+    if(_eeStep != EE_IDLE) return MLX90614_PENDING;
+    shadowUpdate(_eeReg, _eeData, _eeErr);
+#if MLX90614_STATS
+    statError(_eeErr & MLX90614_EECORRUPT);
+#endif
+    _rwError = _eeErr;
+    return MLX90614_DONE;
+}
+
+/**
+ *  \brief            Put the device into sleep mode.
+ *  \remarks          The sleep command is sent with its PEC. The device stops responding until it
+ *                    is woken up with wake(), then goes through its power on initialization.
+ *  \return           False on a R/W error (also set in the R/W error flags property).
+ */
+boolean MLX90614::sleep(void) {
+    CRC8 crc(MLX90614_CRC8POLY, _crcWr);
+    uint8_t buf[2] = {MLX90614_SLEEPCMD, crc.crc8(MLX90614_SLEEPCMD)};
+
+    _rwError = _bus->transmit(_addr, buf, 2);
+    if(_addr == MLX90614_BROADCASTADDR) _rwError &= MLX90614_NORWERROR;
+    return !_rwError;
 }
 
 /**
- *  \brief            Convert temperature in &deg;K to &deg;C.
- *  \param [in] degK  Temperature in &deg;K.
- *  \return           Temperature in &deg;C.
+ *  \brief            First half of the wake up sequence - drive SDA low with SCL high.
+ *  \remarks          Call wakeEnd() no sooner than MLX90614_TWAKELOW later.
+ *  \return           False if the transport cannot drive the bus lines.
  */
-double MLX90614::convKtoC(double degK) {return degK - 273.15;}
+boolean MLX90614::wakeStart(void) {return _bus->wakeLine(true);}
 
 /**
- *  \brief            Convert temperature in &deg;C to &deg;F.
- *  \param [in] degC  Temperature in &deg;C.
- *  \return           Temperature in &deg;F.
+ *  \brief            Second half of the wake up sequence - release SDA.
  */
-double MLX90614::convCtoF(double degC) {return (degC * 1.8) + 32.0;}
+void MLX90614::wakeEnd(void) {_bus->wakeLine(false);}
+
+/**
+ *  \brief            Wake the device from sleep mode (blocks for MLX90614_TWAKELOW).
+ *  \remarks          Every device on the bus is woken. The first valid data follows the power on
+ *                    initialization, see initDone().
+ *  \return           False if the transport cannot drive the bus lines.
+ */
+boolean MLX90614::wake(void) {
+
+    if(!wakeStart()) return false;
+
+    // delay(), delayMicroseconds() is only accurate to 16383us on AVR.
+    delay((MLX90614_TWAKELOW + 999) / 1000);
+    wakeEnd();
+    return true;
+}
+
+/**
+ *  \brief            Return true once the power on initialization has completed (INIT flag).
+ *  \remarks          Returns false with the R/W error flags set if the flags register cannot
+ *                    be read.
+ */
+boolean MLX90614::initDone(void) {
+
+    _rwError = 0;
+    uint16_t flags = read16(MLX90614_RFLAGCMD);
+    return !_rwError && (flags & MLX90614_INIT);
+}
+
+/**
+ *  \brief            Return true when an EEPROM erase/write cycle has finished.
+ *  \remarks          Polls the EEBUSY flag. If the flags register cannot be read (the device does
+ *                    not answer the command on some buses, or a transient error) the library
+ *                    falls back to waiting MLX90614_TEEWRITE for the rest of this write, the
+ *                    flags are tried again at the next eeStart().
+ */
+boolean MLX90614::eeReady(void) {
+
+    if((uint32_t)(micros() - _eeT0) >= MLX90614_TEEWRITE) return true;
+    if(_eeNoFlags) return false;
+
+    uint16_t flags = read16(MLX90614_RFLAGCMD);
+    if(_rwError) {
+        _eeNoFlags = true;
+        _rwError = 0;
+        return false;
+    }
+    return !(flags & MLX90614_EEBUSY);
+}
+
+/**
+ *  \brief            Return a 16 bit EEPROM value from the shadow copy, reading it on a miss.
+ *  \remarks          Without the shadow (MLX90614_EESHADOW = 0) this is readEEProm().
+ *  \param [in] reg   Register address to read from.
+ *  \return           Value of the EEPROM word.
+ */
+uint16_t MLX90614::eeCached(uint8_t reg) {
+#if MLX90614_EESHADOW
+    uint8_t err = _rwError;
+
+    reg &= 0x1f;
+    if(_shadowValid & (1UL << reg)) return _shadow[reg];
+    _rwError = 0;
+    uint16_t val = readEEProm(reg);
+    shadowUpdate(reg, val, _rwError);
+    _rwError |= err;
+    return val;
+#else
+    return readEEProm(reg);
+#endif
+}
+
+/**
+ *  \brief            Return true if an EEPROM word is held in the shadow copy.
+ *  \param [in] reg   Register address.
+ */
+boolean MLX90614::eeKnown(uint8_t reg) {
+#if MLX90614_EESHADOW
+    return (_shadowValid >> (reg & 0x1f)) & 1;
+#else
+    (void)reg;
+    return false;
+#endif
+}
+
+/**
+ *  \brief            Write through to the shadow copy.
+ *  \param [in] reg   Register address.
+ *  \param [in] val   Value now held by the device.
+ *  \param [in] err   R/W error flags of the access, the word is invalidated on any error.
+ */
+void MLX90614::shadowUpdate(uint8_t reg, uint16_t val, uint8_t err) {
+    reg &= 0x1f;
+#if MLX90614_THROTTLE
+    if(reg == MLX90614_CONFIG) _thrPeriod = 0;
+#endif
+#if MLX90614_EESHADOW
+    if(err) _shadowValid &= ~(1UL << reg);
+    else {
+        _shadow[reg] = val;
+        _shadowValid |= 1UL << reg;
+    }
+#endif
+}
+
+/**
+ *  \brief            Discard the shadow copy of the EEPROM.
+ *  \remarks          Use if the EEPROM may have been changed by other means. The next getter
+ *                    call reads the word from the device again. The throttled RAM values are
+ *                    discarded too (eg. after a bus address change they belong to another
+ *                    device).
+ */
+void MLX90614::invalidate(void) {
+#if MLX90614_EESHADOW
+    _shadowValid = 0;
+#endif
+#if MLX90614_THROTTLE
+    _thrPeriod = 0;
+    _thrValid = 0;
+    _thrAge = 0;
+    memset(_thrTime, 0, sizeof(_thrTime));
+#endif
+}
+
+/**
+ *  \brief            Reload the whole shadow copy of the EEPROM from the device.
+ *  \return           R/W error flags of all reads OR'ed together.
+ */
+uint8_t MLX90614::refresh(void) {
+    uint8_t err = 0;
+
+    invalidate();
+#if MLX90614_EESHADOW
+    for(uint8_t i = 0; i < 32; i++) {
+        _rwError = 0;
+        eeCached(i);
+        err |= _rwError;
+    }
+#endif
+    return _rwError = err;
+}
+
+/**
+ *  \brief            Read the whole EEPROM (MLX90614_EEWORDS words) from the device.
+ *  \remarks          The words are read from the device, not the shadow, and the shadow is
+ *                    reloaded with them. A following writeImage() then costs no reads.
+ *  \param [out] image Buffer of MLX90614_EEWORDS words. Unreadable words are set to 0.
+ *  \return           R/W error flags of all reads OR'ed together.
+ */
+uint8_t MLX90614::readImage(uint16_t* image) {
+    uint8_t err = 0;
+
+    for(uint8_t i = 0; i < MLX90614_EEWORDS; i++) {
+        _rwError = 0;
+        uint16_t val = readEEProm(i);
+        shadowUpdate(i, val, _rwError);
+        image[i] = _rwError ? 0 : val;
+        err |= _rwError;
+    }
+    return _rwError = err;
+}
+
+/**
+ *  \brief            Program an EEPROM image, writing only the words that differ.
+ *  \remarks
+ *  \li               Each word is compared with the device (through the shadow, so after
+ *                    readImage() or refresh() the comparison needs no bus transactions). Only
+ *                    differing words are erased, written and read back, the programming time
+ *                    is proportional to the number of changes.
+ *  \li               Words outside the mask are never written. The mask can only narrow
+ *                    MLX90614_EEWRITABLE, the factory calibration words are always protected
+ *                    whatever the mask (use writeEEProm() to change one deliberately).
+ *                    Differences there are reported as skipped if the word is in the shadow
+ *                    (eg. after readImage()), protected words are not read just to be compared.
+ *  \li               Writing MLX90614_ADDR changes the slave address after the next power on.
+ *  \param [in] image Image of MLX90614_EEWORDS words.
+ *  \param [out] report Per word result.
+ *  \param [in] mask  Words that may be written, default (and at most) MLX90614_EEWRITABLE.
+ *  \return           R/W error flags of all accesses OR'ed together.
+ */
+uint8_t MLX90614::writeImage(const uint16_t* image, imageReport_t& report, uint32_t mask) {
+    uint8_t err = 0;
+
+    mask &= MLX90614_EEWRITABLE;
+    memset(&report, 0, sizeof(report));
+    for(uint8_t i = 0; i < MLX90614_EEWORDS; i++) {
+        uint32_t bit = 1UL << i;
+
+        // Protected words are only compared when they are already in the shadow.
+        if(!(mask & bit) && !eeKnown(i)) continue;
+        _rwError = 0;
+        uint16_t val = eeCached(i);
+        if(_rwError) {
+            report.failed |= bit;
+            err |= _rwError;
+            continue;
+        }
+        if(val == image[i]) continue;
+        report.differ |= bit;
+        if(!(mask & bit)) {
+            report.skipped |= bit;
+            continue;
+        }
+        _rwError = 0;
+        writeEEProm(i, image[i]);
+        if(_rwError) report.failed |= bit;
+        else report.written |= bit;
+        err |= _rwError;
+    }
+    return _rwError = err;
+}
+
+#if MLX90614_STATS
+/**
+ *  \brief            Clear the transaction statistics.
+ */
+void MLX90614::resetStats(void) {memset(&_stats, 0, sizeof(_stats));}
+
+/**
+ *  \brief            Return the statistics slot of a command.
+ *  \param [in] cmd   Command (register).
+ *  \return           0...4 RAM, 5...36 EEPROM, 37 flags, 38 other.
+ */
+uint8_t MLX90614::statSlot(uint8_t cmd) {
+
+    if((uint8_t)(cmd - MLX90614_RAWIR1) < 5) return cmd - MLX90614_RAWIR1;
+    if((cmd & 0xe0) == 0x20) return 5 + (cmd & 0x1f);
+    return cmd == MLX90614_RFLAGCMD ? 37 : 38;
+}
+
+/**
+ *  \brief            Record a completed transaction.
+ *  \param [in] cmd   Command (register).
+ *  \param [in] err   R/W error flags of the transaction.
+ *  \param [in] t0    Start time (us).
+ */
+void MLX90614::statTx(uint8_t cmd, uint8_t err, uint32_t t0) {
+    uint32_t dt = micros() - t0;
+    uint8_t  b = 0;
+
+    ++_stats.tx[statSlot(cmd)];
+    statError(err);
+    while((dt >>= 1) && (b < MLX90614_STATBUCKETS - 1)) ++b;
+    ++_stats.latency[b];
+}
+
+/**
+ *  \brief            Count R/W error flags by bit.
+ *  \param [in] err   R/W error flags.
+ */
+void MLX90614::statError(uint8_t err) {
+    for(uint8_t i = 0; err; i++, err >>= 1) if(err & 1) ++_stats.errors[i];
+}
+#endif
 
 /**
  *  \brief            Retrieve the chip ID bytes.
@@ -6,8 +6,9 @@
  *  \par
  *  \par        Details
  *              Based on the Melexis MLX90614 Family Data Sheet 3901090614 Rev 004 09jun2008.
- *  \li         The current implementation does not manage PWM (only digital data by I2C).
- *  \li         Sleep mode is not implemented yet.
+ *  \li         PWM output is not read by this class, see MLX90614Pwm (MLX90614Pwm.h).
+ *  \li         Sleep mode needs a transport that can drive SDA low to wake the device (see
+ *              MLX90614Bus::wakeLine()).
  *
  *  \note       THIS IS ONLY A PARTIAL RELEASE. THIS DEVICE CLASS IS CURRENTLY UNDERGOING
  *              ACTIVE DEVELOPMENT AND IS STILL MISSING SOME IMPORTANT FEATURES. PLEASE KEEP 
@@ -41,9 +42,12 @@
 #else
     #include "WProgram.h"
 #endif
-#include <Wire.h>
+#include <stddef.h>
+#include "MLX90614Config.h"
 #include "Property.h"
+#include "StaticProperty.h"
 #include "Crc8.h"
+#include "MLX90614Bus.h"
 
 /**************************************************************************************************/
 /* Definitions                                                                                    */
@@ -56,6 +60,22 @@
                                              errors after calling Wire.endTransmission()
                                              <em>(possibly due to incompatibility between Wire
                                              library and SMBus protocol)</em>. */
+#define MLX90614_TEEWRITE       5000    /**< EEPROM erase/write time upper bound (us) per
+                                             manufacturer specification */
+#define MLX90614_TCONV1024      100000  /**< Approximate object temperature refresh period with
+                                             FIR N = 1024, single IR sensor (us) */
+#define MLX90614_TWAKELOW       34000   /**< Wake up - SDA held low with SCL high, tDDQ > 33ms (us) */
+#define MLX90614_TINITMAX       250000  /**< Worst case initialization after wake up, used when the
+                                             flags register cannot be read (us) */
+#define MLX90614_TINITPOLL      2000    /**< Flags register poll interval after wake up (us) */
+
+#define MLX90614_STATCMDS       39      /**< Statistics command slots: RAM 0x04...0x08,
+                                             EEPROM 0x20...0x3F, flags, other */
+#define MLX90614_STATBUCKETS    16      /**< Statistics latency histogram log2(us) buckets */
+
+#define MLX90614_RETRYON        (MLX90614_TXADDRNACK | MLX90614_TXDATANACK | MLX90614_RXCRC)
+                                        /**< Default retryable R/W error flags */
+
 /** RAM addresses. */
 #define MLX90614_RAWIR1         0x04    /**< RAM reg - Raw temperature, source #1 */
 #define MLX90614_RAWIR2         0x05    /**< RAM reg - Raw temperature, source #2 */
@@ -63,6 +83,14 @@
 #define MLX90614_TOBJ1          0x07    /**< RAM reg - Linearized temperature, source #1 */
 #define MLX90614_TOBJ2          0x08    /**< RAM reg - Linearized temperature, source #2 */
 
+/** Multi-channel read - channel bitmask (bit n = RAM register MLX90614_RAWIR1 + n). */
+#define MLX90614_CHRAWIR1       0x01    /**< Channel bitmask - Raw IR, source #1 */
+#define MLX90614_CHRAWIR2       0x02    /**< Channel bitmask - Raw IR, source #2 */
+#define MLX90614_CHTA           0x04    /**< Channel bitmask - Ambient temperature */
+#define MLX90614_CHTOBJ1        0x08    /**< Channel bitmask - Object temperature, source #1 */
+#define MLX90614_CHTOBJ2        0x10    /**< Channel bitmask - Object temperature, source #2 */
+#define MLX90614_CHALL          0x1F    /**< Channel bitmask - All RAM registers */
+
 /** EEPROM addresses. */
 #define MLX90614_TOMAX          0x00    /**< EEPROM reg - Customer dependent object temperature range maximum */
 #define MLX90614_TOMIN          0x01    /**< EEPROM reg - Customer dependent object temperature range minimum */
@@ -76,12 +104,18 @@
 #define MLX90614_ID3            0x1E    /**< EEPROM reg - ID numer (w3) */
 #define MLX90614_ID4            0x1F    /**< EEPROM reg - ID numer (w4) */
 
+#define MLX90614_EEWORDS        32      /**< EEPROM size (words) */
+#define MLX90614_EEWRITABLE     0x0200C03FUL    /**< Customer writable EEPROM words bitmask
+                                                     (0x00...0x05, 0x0E, 0x0F, 0x19) */
+
 #define MLX90614_RFLAGCMD       0xF0    /**< Read R/W Flags register command */
+#define MLX90614_SLEEPCMD       0xFF    /**< Enter sleep mode command */
 
 /** Read flags - bitmask. */
 #define MLX90614_EEBUSY         0x80    /**< R/W flag bitmask - EEProm is busy (writing/erasing) */
 #define MLX90614_EE_DEAD        0x20    /**< R/W flag bitmask - EEProm double error has occurred */
-#define MLX90614_INIT           0x10    /**< R/W flag bitmask - POR initialization is still ongoing */
+#define MLX90614_INIT           0x10    /**< R/W flag bitmask - POR initialization is still ongoing
+                                             (low active - the bit is 0 while initializing) */
 
 /** R/W Error flags - bitmask. */
 #define MLX90614_NORWERROR      0       /**< R/W error bitmask - No Errors */
@@ -99,13 +133,33 @@
 /**************************************************************************************************/
 
 class MLX90614 {
+    uint8_t  getRwError(void)   {return _rwError;}          /**< R/W error flags getter */
+    uint8_t  getCRC8(void)      {return _crc8;}             /**< 8 bit CRC getter */
+    uint8_t  getPEC(void)       {return _pec;}              /**< PEC getter */
+
+    uint8_t  getAddr(void);                                 /**< SMB bus address getter */
+    void     setAddr(uint8_t);                              /**< SMB bus address setter */
+
 public:
-    MLX90614(uint8_t i2caddr = MLX90614_I2CDEFAULTADDR);
+    /** Properties - no storage of their own, they share the first byte of the object. */
+    union {
+        StaticProperty<uint8_t, MLX90614, &MLX90614::getAddr, &MLX90614::setAddr>
+                 busAddr;                                   /**< SMBus address property */
+        StaticProperty<uint8_t, MLX90614, &MLX90614::getRwError>
+                 rwError;                                   /**< R/W error flags property */
+        StaticProperty<uint8_t, MLX90614, &MLX90614::getCRC8>
+                 crc8;                                      /**< 8 bit CRC property */
+        StaticProperty<uint8_t, MLX90614, &MLX90614::getPEC>
+                 pec;                                       /**< PEC property */
+    };
+
+    MLX90614(uint8_t i2caddr = MLX90614_I2CDEFAULTADDR, MLX90614Bus* bus = &MLX90614Wire);
 
     boolean  begin();
     boolean  isReady(void) { return _ready; };
     uint64_t readID(void);                                  /**< Chip ID getter */
 
+    uint32_t dataPeriod(void);                              /**< Output refresh period (us) */
     uint8_t  getIIRcoeff(void);                             /**< IIR coefficient getter */
     uint8_t  getFIRcoeff(void);                             /**< FIR coefficient getter */
     float    getEmissivity(void);                           /**< Emissivity getter */
@@ -114,13 +168,84 @@ public:
     void     setFIRcoeff(uint8_t csb = 7);                  /**< FIR coefficient setter */
     void     setEmissivity(float emiss = 1.0);              /**< Emissivity setter */
 
+    /** EEPROM configuration transaction - see beginConfig(). */
+    class config_t {
+    public:
+        config_t& setIIRcoeff(uint8_t csb);                 /**< Stage IIR coefficient */
+        config_t& setFIRcoeff(uint8_t csb);                 /**< Stage FIR coefficient */
+        config_t& setGain(uint8_t csb);                     /**< Stage amplifier gain */
+        config_t& setEmissivity(float emiss);               /**< Stage emissivity */
+        uint8_t   commit(void);                             /**< Write the staged changes */
+    private:
+        friend class MLX90614;
+        MLX90614* _dev;
+        uint16_t  _mask;                                    /**< ConfigRegister1 bits to change */
+        uint16_t  _bits;                                    /**< ConfigRegister1 new bit values */
+        uint16_t  _emiss;                                   /**< Emissivity register new value */
+        boolean   _emissSet;                                /**< Emissivity is staged */
+        uint8_t   _err;                                     /**< R/W error flags */
+        void      stageConfig(uint16_t mask, uint16_t bits);
+    };
+
+    config_t beginConfig(void);                             /**< Start a configuration transaction */
+
+    /** Automatic read retry policy - see setRetry(). */
+    struct retry_t {
+        uint8_t  attempts;                                  /**< Maximum attempts per read (1 = no retry) */
+        uint8_t  retryOn;                                   /**< R/W error flags that are retried */
+        uint16_t backoff;                                   /**< Delay before each retry (us) */
+        uint32_t deadline;                                  /**< No retry that would end after this
+                                                                 time from the first attempt (us,
+                                                                 0 = none) */
+    };
+
+    void     setRetry(const retry_t& policy) {_retry = policy;}     /**< Retry policy setter */
+    retry_t  getRetry(void)     {return _retry;}            /**< Retry policy getter */
+    uint8_t  attempts(void)     {return _attempts;}         /**< Attempts taken by the last read */
+
+#if MLX90614_THROTTLE
+    void     setThrottle(boolean on);                       /**< Skip reads until new data exists */
+    boolean  getThrottle(void)  {return _thrOn;}            /**< Read throttling getter */
+    uint32_t sampleAge(void)    {return _thrAge;}           /**< Age of the last value read (us) */
+    uint32_t readsAvoided(void) {return _thrAvoided;}       /**< Reads served from the cache */
+#endif
+
+#if MLX90614_STATS
+    /** Transaction statistics (MLX90614_STATS = 1). */
+    struct stats_t {
+        uint32_t tx[MLX90614_STATCMDS];                     /**< Transactions per command slot */
+        uint32_t errors[8];                                 /**< Count per R/W error flag bit */
+        uint32_t latency[MLX90614_STATBUCKETS];             /**< Bucket n: 2^n...2^(n+1)-1 us */
+        uint32_t retries;                                   /**< Transactions retried */
+    };
+
+    void     stats(stats_t& snap) {snap = _stats;}          /**< Statistics snapshot */
+    void     resetStats(void);                              /**< Clear the statistics */
+    static uint8_t statSlot(uint8_t cmd);
+#endif
+
+    boolean  sleep(void);                                   /**< Enter sleep mode */
+    boolean  wakeStart(void);                               /**< Wake up - drive SDA low */
+    void     wakeEnd(void);                                 /**< Wake up - release SDA */
+    boolean  wake(void);                                    /**< Wake up (blocking, 34ms) */
+    boolean  initDone(void);                                /**< Initialization after wake up done */
+
     uint16_t readEEProm(uint8_t);
     void     writeEEProm(uint8_t, uint16_t);
+    void     invalidate(void);                              /**< Discard the EEPROM shadow */
+    uint8_t  refresh(void);                                 /**< Reload the EEPROM shadow */
+
+    /** EEPROM image write report - bit n = EEPROM word n. */
+    struct imageReport_t {
+        uint32_t differ;                                    /**< Words that differed from the image */
+        uint32_t written;                                   /**< Words erased, written and verified */
+        uint32_t failed;                                    /**< Words not read, or write/verify failed */
+        uint32_t skipped;                                   /**< Differing words outside the write mask */
+    };
 
-    Property<uint8_t, MLX90614> busAddr;                    /**< SMBus address property */
-    Property<uint8_t, MLX90614> rwError;                    /**< R/W error flags property */
-    Property<uint8_t, MLX90614> crc8;                       /**< 8 bit CRC property */
-    Property<uint8_t, MLX90614> pec;                        /**< PEC property */
+    uint8_t  readImage(uint16_t* image);                    /**< Read the whole EEPROM */
+    uint8_t  writeImage(const uint16_t* image, imageReport_t& report,
+                        uint32_t mask = MLX90614_EEWRITABLE);   /**< Program the differences */
 
     /** Enumerations for temperature units. */
     enum tempUnit_t {MLX90614_TK,                           /**< degrees Kelvin */
@@ -133,27 +258,177 @@ public:
                      MLX90614_SRC02                         /**< IR source #2 */
                     };
 
+    /** Multi-channel snapshot, index = RAM register - MLX90614_RAWIR1. */
+    struct snapshot_t {
+        uint8_t  mask;                                      /**< Channels read (MLX90614_CH*) */
+        uint8_t  errMask;                                   /**< Channels with R/W errors */
+        uint16_t raw[5];                                    /**< Raw register values */
+        uint8_t  error[5];                                  /**< R/W error flags per channel */
+    };
+
+    /** Enumerations for asynchronous read status. */
+    enum pollStat_t {MLX90614_IDLE,                         /**< No read in progress */
+                     MLX90614_PENDING,                      /**< Waiting for the turnaround delay */
+                     MLX90614_DONE                          /**< Read complete, result available */
+                    };
+
     double   readTemp(tempSrc_t = MLX90614_SRC01, tempUnit_t = MLX90614_TC);
-    double   convKtoC(double);
-    double   convCtoF(double);
+
+    /** Asynchronous read. The bus is held, for all devices on it, until poll() is done. */
+    boolean  startRead(tempSrc_t = MLX90614_SRC01, tempUnit_t = MLX90614_TC);
+    boolean  startReadRaw(uint8_t);
+    pollStat_t poll(void);
+    double   result(void)       {return rawToTemp(_asyncRaw, (tempUnit_t)_asyncUnit);}  /**< Async temperature */
+    uint16_t rawResult(void)    {return _asyncRaw;}         /**< Async raw register value */
+    uint8_t  readAll(snapshot_t&, uint8_t = MLX90614_CHALL);
+
+    boolean  eeStart(uint8_t, uint16_t);
+    pollStat_t eePoll(void);
+    double   rawToTemp(uint16_t, tempUnit_t = MLX90614_TC);
+
+    /** Integer temperature path - hundredths of a degree, exact, no floating point. */
+    int32_t  readTempFixed(tempSrc_t = MLX90614_SRC01, tempUnit_t = MLX90614_TC);
+    static int32_t rawToFixed(uint16_t, tempUnit_t = MLX90614_TC);
+    static constexpr int32_t rawToCentiK(uint16_t raw) {return (int32_t)raw * 2;}
+    static constexpr int32_t centiKtoC(int32_t cK)     {return cK - 27315;}
+    static constexpr int32_t centiCtoF(int32_t cC)     {return (cC * 9 + (cC < 0 ? -2 : 2)) / 5 + 3200;}
+
+    /** Floating point temperature path, shared with MLX90614Static. */
+    static constexpr double rawToK(uint16_t raw)       {return raw * 0.02;}
+    static constexpr double convKtoC(double degK)      {return degK - 273.15;}
+    static constexpr double convCtoF(double degC)      {return (degC * 1.8) + 32.0;}
+    static constexpr double convKto(double degK, tempUnit_t tunit) {
+        return tunit == MLX90614_TC ? convKtoC(degK) :
+               tunit == MLX90614_TF ? convCtoF(convKtoC(degK)) : degK;
+    }
+
+    /** SMBus read word transaction, shared with MLX90614Static. */
+    static uint16_t readWord(MLX90614Bus*, uint8_t, uint8_t, uint8_t, uint8_t&, uint8_t&, uint8_t&);
+    static uint16_t fetchWord(MLX90614Bus*, uint8_t, uint8_t, uint8_t&, uint8_t&, uint8_t&);
 
 private:
     boolean  _ready;
     uint8_t  _addr;                                         /**< Slave address */
+    MLX90614Bus* _bus;                                      /**< Bus transport */
     uint8_t  _rwError;                                      /**< R/W error flags */
     uint8_t  _crc8;                                         /**< 8 bit CRC */
     uint8_t  _pec;                                          /**< PEC */
+    uint8_t  _crcWr;                                        /**< CRC of the write address byte */
+    uint8_t  _crcRd[5];                                     /**< CRC of the read header, RAM regs */
+    boolean  _pending;                                      /**< Async read in progress */
+    uint8_t  _asyncCmd;                                     /**< Async read command */
+    uint8_t  _asyncErr;                                     /**< Async read R/W error flags */
+    uint8_t  _asyncUnit;                                    /**< Async read temperature units */
+    uint16_t _asyncRaw;                                     /**< Async read result */
+    uint32_t _asyncT0;                                      /**< Async read start time (us) */
+    uint8_t  _eeStep;                                       /**< EEPROM write step */
+    uint8_t  _eeReg;                                        /**< EEPROM write command */
+    uint8_t  _eeErr;                                        /**< EEPROM write R/W error flags */
+    boolean  _eeNoFlags;                                    /**< Flags unreadable during this write */
+    uint16_t _eeData;                                       /**< EEPROM write data */
+    uint32_t _eeT0;                                         /**< EEPROM erase/write start (us) */
+    retry_t  _retry;                                        /**< Read retry policy */
+    uint8_t  _attempts;                                     /**< Attempts taken by the last read */
+#if MLX90614_STATS
+    stats_t  _stats;                                        /**< Transaction statistics */
+#endif
+#if MLX90614_THROTTLE
+    boolean  _thrOn;                                        /**< Read throttling enabled */
+    uint8_t  _thrValid;                                     /**< Cached RAM registers bitmask */
+    uint16_t _thrRaw[5];                                    /**< Last value, RAM registers */
+    uint32_t _thrTime[5];                                   /**< Time of the last value (us) */
+    uint32_t _thrPeriod;                                    /**< Output refresh period, 0 = unknown */
+    uint32_t _thrAge;                                       /**< Age of the last value read (us) */
+    uint32_t _thrAvoided;                                   /**< Reads served from the cache */
+#endif
+#if MLX90614_EESHADOW
+    uint32_t _shadowValid;                                  /**< EEPROM shadow valid words bitmask */
+    uint16_t _shadow[32];                                   /**< EEPROM shadow */
+#endif
 
     uint16_t read16(uint8_t);
+    uint16_t readOnce(uint8_t);
+    void     readStart(uint8_t);
+    uint16_t readFinish(uint8_t);
     void     write16(uint8_t, uint16_t);
+    void     setBusAddr(uint8_t);
+    uint8_t  readPrefix(uint8_t);
+    uint8_t  srcReg(tempSrc_t);
+    boolean  eeReady(void);
+    uint16_t eeCached(uint8_t);
+    boolean  eeKnown(uint8_t);
+    static uint32_t periodOf(uint16_t);
+    void     shadowUpdate(uint8_t, uint16_t, uint8_t);
+#if MLX90614_STATS
+    void     statTx(uint8_t, uint8_t, uint32_t);
+    void     statError(uint8_t);
+#endif
+};
 
-    uint8_t  getRwError(void)   {return _rwError;}          /**< R/W error flags getter */
-    uint8_t  getCRC8(void)      {return _crc8;}             /**< 8 bit CRC getter */
-    uint8_t  getPEC(void)       {return _pec;}              /**< PEC getter */
+/**
+ *  \brief             Complete read word transaction - send the command, wait for the transport
+ *                     turnaround, fetch the data and check the PEC.
+ *  \param [in] bus    Bus transport.
+ *  \param [in] addr   Slave address.
+ *  \param [in] cmd    Command to send (register to read from).
+ *  \param [in] prefix CRC-8 of the read header <tt>addr<<1, cmd, (addr<<1)+1</tt>.
+ *  \param [in,out] err R/W error flags, the transaction's flags are OR'ed in.
+ *  \param [out] pec   PEC received.
+ *  \param [out] crc   PEC calculated.
+ *  \return            Value read.
+ */
+inline uint16_t MLX90614::readWord(MLX90614Bus* bus, uint8_t addr, uint8_t cmd, uint8_t prefix,
+                                   uint8_t& err, uint8_t& pec, uint8_t& crc) {
 
-    uint8_t  getAddr(void);                                 /**< SMB bus address getter */
-    void     setAddr(uint8_t);                              /**< SMB bus address setter */
+    // Send the slave address then the command and set any error status bits returned by the write.
+    err |= bus->sendCommand(addr, cmd);
 
-};
+    // Wait for the turnaround delay required by the transport (see MLX90614_XDLY).
+    if(uint16_t dly = bus->turnaround()) delayMicroseconds(dly);
+
+    return fetchWord(bus, addr, prefix, err, pec, crc);
+}
+
+/**
+ *  \brief             Second half of a read word transaction - fetch the data and check the PEC.
+ *  \remarks           With the broadcast address the R/W errors are cleared, all of them.
+ *  \param [in] bus    Bus transport.
+ *  \param [in] addr   Slave address.
+ *  \param [in] prefix CRC-8 of the read header.
+ *  \param [in,out] err R/W error flags, the transaction's flags are OR'ed in.
+ *  \param [out] pec   PEC received.
+ *  \param [out] crc   PEC calculated.
+ *  \return            Value read.
+ */
+inline uint16_t MLX90614::fetchWord(MLX90614Bus* bus, uint8_t addr, uint8_t prefix,
+                                    uint8_t& err, uint8_t& pec, uint8_t& crc) {
+    uint8_t buf[3];
+
+    // Resend slave address then get the 3 returned bytes, data little endian then the PEC.
+    err |= bus->receive(addr, buf, 3);
+    uint16_t val = buf[0] | (buf[1] << 8);
+    pec = buf[2];
+
+    // Clear r/w errors if using broadcast address.
+    if(addr == MLX90614_BROADCASTADDR) err &= MLX90614_NORWERROR;
+
+    // Build our own CRC-8 of all received bytes, starting from the CRC of the header.
+    CRC8 c(MLX90614_CRC8POLY, prefix);
+    c.crc8(lowByte(val));
+    crc = c.crc8(highByte(val));
+
+    // Set error status bit if CRC mismatch.
+    if(crc != pec) err |= MLX90614_RXCRC;
+    return val;
+}
+
+// The properties find the object by casting their own address (see StaticProperty.h). Fail the
+// build if a base class, a virtual function or a member ahead of the union moves them.
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Winvalid-offsetof"
+static_assert(offsetof(MLX90614, busAddr) == 0 && offsetof(MLX90614, rwError) == 0 &&
+              offsetof(MLX90614, crc8) == 0 && offsetof(MLX90614, pec) == 0,
+              "MLX90614 properties must be at offset 0");
+#pragma GCC diagnostic pop
 
 #endif /* _MLX90614_H_  */
@@ -0,0 +1,290 @@
+/***********************************************************************************************//**
+ *  \brief      Melexis MLX90614 Family Device Driver Library - Batch conversion CPP Source file.
+ *  \file       MLX90614BATCH.CPP
+ *  \author     J. F. Fitter <jfitter@eagleairaust.com.au>
+ *  \version    1.0
+ *  \date       2014-2017
+ *  \copyright  Copyright &copy; 2017 John Fitter.  All right reserved.
+ *
+ *  \par        License
+ *              This program is free software; you can redistribute it and/or modify it under
+ *              the terms of the GNU Lesser General Public License as published by the Free
+ *              Software Foundation; either version 2.1 of the License, or (at your option)
+ *              any later version.
+ *  \par
+ *              This Program is distributed in the hope that it will be useful, but WITHOUT ANY
+ *              WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *              PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details
+ *              at http://www.gnu.org/copyleft/gpl.html
+ *  \par
+ *              You should have received a copy of the GNU Lesser General Public License along
+ *              with this library; if not, write to the Free Software Foundation, Inc.,
+ *              51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *//***********************************************************************************************/
+
+#include <math.h>
+#include "MLX90614Batch.h"
+
+#if MLX90614_BATCHSIMD && defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && \
+    defined(__SSE2__)
+#define MLX90614_BATCHX86       1
+#include <immintrin.h>
+#else
+#define MLX90614_BATCHX86       0
+#endif
+
+/**************************************************************************************************/
+/*  Conversion constants - T = raw * scale + offset (float), see MLX90614::rawToTemp().           */
+/**************************************************************************************************/
+
+static const float batchScale[3]  = {0.02f, 0.02f, 0.036f};
+static const float batchOffset[3] = {0.0f, -273.15f, -459.67f};
+
+static MLX90614Batch::kernel_t batchKernel(void);
+static MLX90614Batch::kernel_t _kernel = batchKernel();
+
+/**************************************************************************************************/
+/*  Scalar kernels - also convert the tail of the vector kernels.                                */
+/**************************************************************************************************/
+
+/**
+ *  \brief  Convert words [i, n) to float, the mask bytes from i/8 are written. i is a multiple of 8.
+ *  \return Number of error words.
+ */
+static size_t floatScalar(const uint16_t* raw, float* out, uint8_t* errMask, size_t i, size_t n,
+                          uint8_t unit) {
+    float s = batchScale[unit], o = batchOffset[unit];
+    size_t nerr = 0;
+
+    for(; i < n; i++) {
+        uint16_t w = raw[i];
+        if(!(i & 7)) errMask[i >> 3] = 0;
+        if(w & 0x8000) {
+            out[i] = NAN;
+            errMask[i >> 3] |= 1 << (i & 7);
+            ++nerr;
+        } else out[i] = (float)w * s + o;
+    }
+    return nerr;
+}
+
+/**
+ *  \brief  Convert words [i, n) to fixed point, the mask bytes from i/8 are written.
+ *  \return Number of error words.
+ */
+static size_t fixedScalar(const uint16_t* raw, int32_t* out, uint8_t* errMask, size_t i, size_t n,
+                          MLX90614::tempUnit_t unit) {
+    size_t nerr = 0;
+
+    for(; i < n; i++) {
+        uint16_t w = raw[i];
+        if(!(i & 7)) errMask[i >> 3] = 0;
+        if(w & 0x8000) {
+            out[i] = MLX90614_FIXEDINVALID;
+            errMask[i >> 3] |= 1 << (i & 7);
+            ++nerr;
+        } else out[i] = MLX90614::rawToFixed(w, unit);
+    }
+    return nerr;
+}
+
+#if MLX90614_BATCHX86
+/**************************************************************************************************/
+/*  SSE2 kernels - 8 words per step.                                                              */
+/*  Fixed point F: (cC * 9 +/- 2) / 5 truncated is cC * 1.8 rounded to nearest, which never ties  */
+/*  (the fraction is a multiple of 0.2), so it is computed in float with the default rounding.    */
+/**************************************************************************************************/
+
+static size_t floatSse2(const uint16_t* raw, float* out, uint8_t* errMask, size_t n, uint8_t unit) {
+    const __m128 s = _mm_set1_ps(batchScale[unit]), o = _mm_set1_ps(batchOffset[unit]);
+    const __m128 nan = _mm_set1_ps(NAN);
+    const __m128i z = _mm_setzero_si128();
+    size_t nerr = 0, i = 0;
+
+    for(; i + 8 <= n; i += 8) {
+        __m128i w = _mm_loadu_si128((const __m128i*)(raw + i));
+        __m128i e = _mm_srai_epi16(w, 15);
+        __m128  lo = _mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(w, z)), s), o);
+        __m128  hi = _mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(w, z)), s), o);
+        __m128  elo = _mm_castsi128_ps(_mm_unpacklo_epi16(e, e));
+        __m128  ehi = _mm_castsi128_ps(_mm_unpackhi_epi16(e, e));
+        _mm_storeu_ps(out + i, _mm_or_ps(_mm_andnot_ps(elo, lo), _mm_and_ps(elo, nan)));
+        _mm_storeu_ps(out + i + 4, _mm_or_ps(_mm_andnot_ps(ehi, hi), _mm_and_ps(ehi, nan)));
+        uint8_t m = _mm_movemask_epi8(_mm_packs_epi16(e, z));
+        errMask[i >> 3] = m;
+        nerr += __builtin_popcount(m);
+    }
+    return nerr + floatScalar(raw, out, errMask, i, n, unit);
+}
+
+/** Four centi-Kelvin values to the unit. */
+static inline __m128i fixedUnit4(__m128i cK, MLX90614::tempUnit_t unit) {
+
+    if(unit == MLX90614::MLX90614_TK) return cK;
+    __m128i cC = _mm_sub_epi32(cK, _mm_set1_epi32(27315));
+    if(unit == MLX90614::MLX90614_TC) return cC;
+    __m128 x9 = _mm_cvtepi32_ps(_mm_add_epi32(_mm_slli_epi32(cC, 3), cC));
+    return _mm_add_epi32(_mm_cvtps_epi32(_mm_mul_ps(x9, _mm_set1_ps(0.2f))), _mm_set1_epi32(3200));
+}
+
+static size_t fixedSse2(const uint16_t* raw, int32_t* out, uint8_t* errMask, size_t n,
+                        MLX90614::tempUnit_t unit) {
+    const __m128i inv = _mm_set1_epi32(MLX90614_FIXEDINVALID);
+    const __m128i z = _mm_setzero_si128();
+    size_t nerr = 0, i = 0;
+
+    for(; i + 8 <= n; i += 8) {
+        __m128i w = _mm_loadu_si128((const __m128i*)(raw + i));
+        __m128i e = _mm_srai_epi16(w, 15);
+        __m128i lo = fixedUnit4(_mm_slli_epi32(_mm_unpacklo_epi16(w, z), 1), unit);
+        __m128i hi = fixedUnit4(_mm_slli_epi32(_mm_unpackhi_epi16(w, z), 1), unit);
+        __m128i elo = _mm_unpacklo_epi16(e, e), ehi = _mm_unpackhi_epi16(e, e);
+        _mm_storeu_si128((__m128i*)(out + i), _mm_or_si128(_mm_andnot_si128(elo, lo), _mm_and_si128(elo, inv)));
+        _mm_storeu_si128((__m128i*)(out + i + 4), _mm_or_si128(_mm_andnot_si128(ehi, hi), _mm_and_si128(ehi, inv)));
+        uint8_t m = _mm_movemask_epi8(_mm_packs_epi16(e, z));
+        errMask[i >> 3] = m;
+        nerr += __builtin_popcount(m);
+    }
+    return nerr + fixedScalar(raw, out, errMask, i, n, unit);
+}
+
+/**************************************************************************************************/
+/*  AVX2 kernels - 16 words per step, compiled for AVX2 whatever the build flags.                */
+/**************************************************************************************************/
+
+__attribute__((target("avx2")))
+static size_t floatAvx2(const uint16_t* raw, float* out, uint8_t* errMask, size_t n, uint8_t unit) {
+    const __m256 s = _mm256_set1_ps(batchScale[unit]), o = _mm256_set1_ps(batchOffset[unit]);
+    const __m256 nan = _mm256_set1_ps(NAN);
+    size_t nerr = 0, i = 0;
+
+    for(; i + 16 <= n; i += 16) {
+        __m128i w0 = _mm_loadu_si128((const __m128i*)(raw + i));
+        __m128i w1 = _mm_loadu_si128((const __m128i*)(raw + i + 8));
+        __m128i e0 = _mm_srai_epi16(w0, 15), e1 = _mm_srai_epi16(w1, 15);
+        __m256  lo = _mm256_add_ps(_mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_cvtepu16_epi32(w0)), s), o);
+        __m256  hi = _mm256_add_ps(_mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_cvtepu16_epi32(w1)), s), o);
+        _mm256_storeu_ps(out + i, _mm256_blendv_ps(lo, nan, _mm256_castsi256_ps(_mm256_cvtepi16_epi32(e0))));
+        _mm256_storeu_ps(out + i + 8, _mm256_blendv_ps(hi, nan, _mm256_castsi256_ps(_mm256_cvtepi16_epi32(e1))));
+        uint32_t m = _mm_movemask_epi8(_mm_packs_epi16(e0, e1));
+        errMask[i >> 3] = (uint8_t)m;
+        errMask[(i >> 3) + 1] = (uint8_t)(m >> 8);
+        nerr += __builtin_popcount(m);
+    }
+    return nerr + floatScalar(raw, out, errMask, i, n, unit);
+}
+
+/** Eight centi-Kelvin values to the unit. */
+__attribute__((target("avx2")))
+static inline __m256i fixedUnit8(__m256i cK, MLX90614::tempUnit_t unit) {
+
+    if(unit == MLX90614::MLX90614_TK) return cK;
+    __m256i cC = _mm256_sub_epi32(cK, _mm256_set1_epi32(27315));
+    if(unit == MLX90614::MLX90614_TC) return cC;
+    __m256 x9 = _mm256_cvtepi32_ps(_mm256_add_epi32(_mm256_slli_epi32(cC, 3), cC));
+    return _mm256_add_epi32(_mm256_cvtps_epi32(_mm256_mul_ps(x9, _mm256_set1_ps(0.2f))),
+                            _mm256_set1_epi32(3200));
+}
+
+__attribute__((target("avx2")))
+static size_t fixedAvx2(const uint16_t* raw, int32_t* out, uint8_t* errMask, size_t n,
+                        MLX90614::tempUnit_t unit) {
+    const __m256 inv = _mm256_castsi256_ps(_mm256_set1_epi32(MLX90614_FIXEDINVALID));
+    size_t nerr = 0, i = 0;
+
+    for(; i + 16 <= n; i += 16) {
+        __m128i w0 = _mm_loadu_si128((const __m128i*)(raw + i));
+        __m128i w1 = _mm_loadu_si128((const __m128i*)(raw + i + 8));
+        __m128i e0 = _mm_srai_epi16(w0, 15), e1 = _mm_srai_epi16(w1, 15);
+        __m256  lo = _mm256_castsi256_ps(fixedUnit8(_mm256_slli_epi32(_mm256_cvtepu16_epi32(w0), 1), unit));
+        __m256  hi = _mm256_castsi256_ps(fixedUnit8(_mm256_slli_epi32(_mm256_cvtepu16_epi32(w1), 1), unit));
+        lo = _mm256_blendv_ps(lo, inv, _mm256_castsi256_ps(_mm256_cvtepi16_epi32(e0)));
+        hi = _mm256_blendv_ps(hi, inv, _mm256_castsi256_ps(_mm256_cvtepi16_epi32(e1)));
+        _mm256_storeu_si256((__m256i*)(out + i), _mm256_castps_si256(lo));
+        _mm256_storeu_si256((__m256i*)(out + i + 8), _mm256_castps_si256(hi));
+        uint32_t m = _mm_movemask_epi8(_mm_packs_epi16(e0, e1));
+        errMask[i >> 3] = (uint8_t)m;
+        errMask[(i >> 3) + 1] = (uint8_t)(m >> 8);
+        nerr += __builtin_popcount(m);
+    }
+    return nerr + fixedScalar(raw, out, errMask, i, n, unit);
+}
+#endif
+
+/**************************************************************************************************/
+/*  MLX90614 Batch conversion functions.                                                          */
+/**************************************************************************************************/
+
+/**
+ *  \brief  Return the best kernel for this processor.
+ */
+static MLX90614Batch::kernel_t batchKernel(void) {
+#if MLX90614_BATCHX86
+    __builtin_cpu_init();                                   // May run before static constructors
+    if(__builtin_cpu_supports("avx2")) return MLX90614Batch::MLX90614_AVX2;
+    return MLX90614Batch::MLX90614_SSE2;
+#else
+    return MLX90614Batch::MLX90614_SCALAR;
+#endif
+}
+
+/**
+ *  \brief              Convert raw temperature words to float.
+ *  \param [in] raw     Raw words, resolution 0.02&deg;K.
+ *  \param [out] out    n temperatures. Error words give NAN.
+ *  \param [out] errMask Error word bitmask, (n + 7) / 8 bytes. Bit i%8 of byte i/8 is set if
+ *                      raw[i] has the MSB set.
+ *  \param [in] n       Number of words.
+ *  \param [in] unit    Temperature units, default &deg;C.
+ *  \return             Number of error words.
+ */
+size_t MLX90614Batch::toFloat(const uint16_t* raw, float* out, uint8_t* errMask, size_t n,
+                              MLX90614::tempUnit_t unit) {
+#if MLX90614_BATCHX86
+    if(_kernel == MLX90614_AVX2) return floatAvx2(raw, out, errMask, n, unit);
+    if(_kernel == MLX90614_SSE2) return floatSse2(raw, out, errMask, n, unit);
+#endif
+    return floatScalar(raw, out, errMask, 0, n, unit);
+}
+
+/**
+ *  \brief              Convert raw temperature words to hundredths of a degree.
+ *  \param [in] raw     Raw words, resolution 0.02&deg;K.
+ *  \param [out] out    n temperatures in centi-degrees. Error words give MLX90614_FIXEDINVALID.
+ *  \param [out] errMask Error word bitmask, (n + 7) / 8 bytes, see toFloat().
+ *  \param [in] n       Number of words.
+ *  \param [in] unit    Temperature units, default &deg;C.
+ *  \return             Number of error words.
+ */
+size_t MLX90614Batch::toFixed(const uint16_t* raw, int32_t* out, uint8_t* errMask, size_t n,
+                              MLX90614::tempUnit_t unit) {
+#if MLX90614_BATCHX86
+    if(_kernel == MLX90614_AVX2) return fixedAvx2(raw, out, errMask, n, unit);
+    if(_kernel == MLX90614_SSE2) return fixedSse2(raw, out, errMask, n, unit);
+#endif
+    return fixedScalar(raw, out, errMask, 0, n, unit);
+}
+
+/**
+ *  \brief              Return the kernel in use.
+ */
+MLX90614Batch::kernel_t MLX90614Batch::kernel(void) {return _kernel;}
+
+/**
+ *  \brief              Return true if a kernel can run on this processor.
+ *  \param [in] k       Kernel.
+ */
+boolean MLX90614Batch::supported(kernel_t k) {return k <= batchKernel();}
+
+/**
+ *  \brief              Select the conversion kernel, the best one is selected by default.
+ *  \param [in] k       Kernel.
+ *  \return             False (kernel unchanged) if it cannot run on this processor.
+ */
+boolean MLX90614Batch::setKernel(kernel_t k) {
+
+    if(!supported(k)) return false;
+    _kernel = k;
+    return true;
+}
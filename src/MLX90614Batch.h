@@ -0,0 +1,78 @@
+#ifndef _MLX90614BATCH_H_
+#define _MLX90614BATCH_H_
+
+/***********************************************************************************************//**
+ *  \brief      Melexis MLX90614 Family Device Driver Library - Batch raw word conversion.
+ *  \par
+ *  \par        Details
+ *              Converts arrays of raw temperature words (0.02&deg;K, eg. logged TOBJ1/TA values)
+ *              to float or fixed point temperatures in one call, for post-processing on a host
+ *              or gateway.
+ *  \li         Float results match MLX90614::rawToTemp() to float precision. Fixed point results
+ *              (hundredths of a degree) are identical to MLX90614::rawToFixed().
+ *  \li         Words with the MSB set are error words (the device sets it on an invalid result).
+ *              Their bits are set in a parallel bitmask (bit i%8 of byte i/8), and the result is
+ *              NAN (float) or MLX90614_FIXEDINVALID (fixed point).
+ *  \li         On x86 an SSE2 kernel (8 words per step) is used, and an AVX2 kernel (16 words per
+ *              step) when the processor supports it, selected at run time. Other processors use
+ *              the scalar loop. Define MLX90614_BATCHSIMD as 0 to build the scalar loop only.
+ *
+ *  \file       MLX90614BATCH.H
+ *  \author     J. F. Fitter <jfitter@eagleairaust.com.au>
+ *  \version    1.0
+ *  \date       2014-2017
+ *  \copyright  Copyright &copy; 2017 John Fitter.  All right reserved.
+ *
+ *  \par        License
+ *              This program is free software; you can redistribute it and/or modify it under
+ *              the terms of the GNU Lesser General Public License as published by the Free
+ *              Software Foundation; either version 2.1 of the License, or (at your option)
+ *              any later version.
+ *  \par
+ *              This Program is distributed in the hope that it will be useful, but WITHOUT ANY
+ *              WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *              PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details
+ *              at http://www.gnu.org/copyleft/gpl.html
+ *  \par
+ *              You should have received a copy of the GNU Lesser General Public License along
+ *              with this library; if not, write to the Free Software Foundation, Inc.,
+ *              51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *//***********************************************************************************************/
+
+#include <stddef.h>
+#include "MLX90614.h"
+
+/**************************************************************************************************/
+/* Definitions                                                                                    */
+/**************************************************************************************************/
+
+#ifndef MLX90614_BATCHSIMD
+#define MLX90614_BATCHSIMD      1       /**< Use the SSE2/AVX2 kernels where available */
+#endif
+
+#define MLX90614_FIXEDINVALID   ((int32_t)0x80000000L)  /**< Fixed point result of an error word */
+
+/**************************************************************************************************/
+/* MLX90614 Batch conversion class.                                                               */
+/**************************************************************************************************/
+
+class MLX90614Batch {
+public:
+    /** Enumerations for the conversion kernels. */
+    enum kernel_t {MLX90614_SCALAR,                         /**< Portable loop */
+                   MLX90614_SSE2,                           /**< x86 SSE2, 8 words per step */
+                   MLX90614_AVX2                            /**< x86 AVX2, 16 words per step */
+                  };
+
+    static size_t   toFloat(const uint16_t* raw, float* out, uint8_t* errMask, size_t n,
+                            MLX90614::tempUnit_t unit = MLX90614::MLX90614_TC);
+    static size_t   toFixed(const uint16_t* raw, int32_t* out, uint8_t* errMask, size_t n,
+                            MLX90614::tempUnit_t unit = MLX90614::MLX90614_TC);
+
+    static kernel_t kernel(void);                           /**< Kernel in use */
+    static boolean  supported(kernel_t k);                  /**< Kernel can run on this processor */
+    static boolean  setKernel(kernel_t k);                  /**< Select a kernel (eg. to compare) */
+};
+
+#endif /* _MLX90614BATCH_H_ */
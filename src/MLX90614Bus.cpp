@@ -0,0 +1,106 @@
+/***********************************************************************************************//**
+ *  \brief      Melexis MLX90614 Family Device Driver Library - Bus transport CPP Source file.
+ *  \file       MLX90614BUS.CPP
+ *  \author     J. F. Fitter <jfitter@eagleairaust.com.au>
+ *  \version    1.0
+ *  \date       2014-2017
+ *  \copyright  Copyright &copy; 2017 John Fitter.  All right reserved.
+ *
+ *  \par        License
+ *              This program is free software; you can redistribute it and/or modify it under
+ *              the terms of the GNU Lesser General Public License as published by the Free
+ *              Software Foundation; either version 2.1 of the License, or (at your option)
+ *              any later version.
+ *  \par
+ *              This Program is distributed in the hope that it will be useful, but WITHOUT ANY
+ *              WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *              PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details
+ *              at http://www.gnu.org/copyleft/gpl.html
+ *  \par
+ *              You should have received a copy of the GNU Lesser General Public License along
+ *              with this library; if not, write to the Free Software Foundation, Inc.,
+ *              51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *//***********************************************************************************************/
+
+#include <Wire.h>
+#include "MLX90614.h"
+
+/**************************************************************************************************/
+/*  MLX90614 Wire library transport functions.                                                    */
+/**************************************************************************************************/
+
+MLX90614WireBus MLX90614Wire;
+
+/**
+ *  \brief            Send the slave address then the command, without a stop condition.
+ *  \param [in] addr  Slave address.
+ *  \param [in] cmd   Command to send.
+ *  \return           R/W error flags returned by the write.
+ */
+uint8_t MLX90614WireBus::sendCommand(uint8_t addr, uint8_t cmd) {
+
+    Wire.beginTransmission(addr);
+    Wire.write(cmd);
+    return (1 << Wire.endTransmission(false)) >> 1;
+}
+
+/**
+ *  \brief            Resend the slave address then get the returned bytes.
+ *  \param [in] addr  Slave address.
+ *  \param [out] buf  Buffer to receive the bytes.
+ *  \param [in] len   Number of bytes to receive.
+ *  \return           R/W error flags (the Wire library does not report read errors).
+ */
+uint8_t MLX90614WireBus::receive(uint8_t addr, uint8_t* buf, uint8_t len) {
+
+    Wire.requestFrom(addr, len);
+    while(len--) *buf++ = Wire.read();
+    return MLX90614_NORWERROR;
+}
+
+/**
+ *  \brief            Send the slave address then the buffer, followed by a stop condition.
+ *  \param [in] addr  Slave address.
+ *  \param [in] buf   Bytes to send.
+ *  \param [in] len   Number of bytes to send.
+ *  \return           R/W error flags returned by the write.
+ */
+uint8_t MLX90614WireBus::transmit(uint8_t addr, const uint8_t* buf, uint8_t len) {
+
+    Wire.beginTransmission(addr);
+    while(len--) Wire.write(*buf++);
+    return (1 << Wire.endTransmission(true)) >> 1;
+}
+
+/**
+ *  \brief            Experimentally determined delay to prevent read errors (manufacturer's data
+ *                    sheet has left something out).
+ *  \return           Delay between command and read in microseconds.
+ */
+uint16_t MLX90614WireBus::turnaround(void) {return MLX90614_XDLY;}
+
+/**
+ *  \brief            Drive the wake up condition through the user pin hook, eg. on an AVR;
+ *  \code
+ *  void wakeHook(boolean low) {
+ *      if(low) {
+ *          TWCR = 0;                                       // Release the TWI pins
+ *          pinMode(SCL, INPUT_PULLUP);
+ *          pinMode(SDA, OUTPUT);
+ *          digitalWrite(SDA, LOW);
+ *      } else {
+ *          pinMode(SDA, INPUT_PULLUP);
+ *          Wire.begin();
+ *      }
+ *  }
+ *  \endcode
+ *  \param [in] low   True to drive SDA low, false to release it.
+ *  \return           False if no hook has been set.
+ */
+boolean MLX90614WireBus::wakeLine(boolean low) {
+
+    if(!_wakeHook) return false;
+    _wakeHook(low);
+    return true;
+}
@@ -0,0 +1,96 @@
+#ifndef _MLX90614BUS_H_
+#define _MLX90614BUS_H_
+
+/***********************************************************************************************//**
+ *  \brief      Melexis MLX90614 Family Device Driver Library - Bus transport interface.
+ *  \par
+ *  \par        Details
+ *              The device class does not talk to the Wire library directly. Every SMBus
+ *              transaction is issued through an MLX90614Bus object so that the driver can be
+ *              run against other transports (eg. a simulated device on a host computer).
+ *  \li         A read word transaction is split into sendCommand() followed by receive().
+ *              The driver waits turnaround() microseconds between the two.
+ *  \li         A write word transaction is a single transmit() of command, data and PEC.
+ *  \li         wakeLine() drives SDA low with SCL high to wake a device from sleep mode. The
+ *              Wire transport does this through a user supplied pin hook.
+ *  \li         All functions return the MLX90614 R/W error bitmask (MLX90614_NORWERROR = 0 on
+ *              success).
+ *
+ *  \file       MLX90614BUS.H
+ *  \author     J. F. Fitter <jfitter@eagleairaust.com.au>
+ *  \version    1.0
+ *  \date       2014-2017
+ *  \copyright  Copyright &copy; 2017 John Fitter.  All right reserved.
+ *
+ *  \par        License
+ *              This program is free software; you can redistribute it and/or modify it under
+ *              the terms of the GNU Lesser General Public License as published by the Free
+ *              Software Foundation; either version 2.1 of the License, or (at your option)
+ *              any later version.
+ *  \par
+ *              This Program is distributed in the hope that it will be useful, but WITHOUT ANY
+ *              WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *              PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details
+ *              at http://www.gnu.org/copyleft/gpl.html
+ *  \par
+ *              You should have received a copy of the GNU Lesser General Public License along
+ *              with this library; if not, write to the Free Software Foundation, Inc.,
+ *              51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *//***********************************************************************************************/
+
+#if (ARDUINO >= 100)
+    #include "Arduino.h"
+#else
+    #include "WProgram.h"
+#endif
+
+/**************************************************************************************************/
+/* MLX90614 Bus transport interface.                                                              */
+/**************************************************************************************************/
+
+class MLX90614Bus {
+public:
+    virtual ~MLX90614Bus() {}
+
+    /** Send the slave address and command byte, leaving the bus ready for a repeated start. */
+    virtual uint8_t  sendCommand(uint8_t addr, uint8_t cmd) = 0;
+
+    /** Resend the slave address (read) and receive len bytes into buf. */
+    virtual uint8_t  receive(uint8_t addr, uint8_t* buf, uint8_t len) = 0;
+
+    /** Send the slave address then len bytes from buf, followed by a stop condition. */
+    virtual uint8_t  transmit(uint8_t addr, const uint8_t* buf, uint8_t len) = 0;
+
+    /** Delay required between sendCommand() and receive() in microseconds. */
+    virtual uint16_t turnaround(void) {return 0;}
+
+    /** Drive SDA low (true) or release it (false) with SCL high. False if not supported. */
+    virtual boolean  wakeLine(boolean low) {(void)low; return false;}
+};
+
+/**************************************************************************************************/
+/* MLX90614 Wire library transport.                                                               */
+/**************************************************************************************************/
+
+/** Pin hook - low: stop the Wire library, SCL high, SDA low. Not low: release SDA, restart Wire. */
+typedef void (*MLX90614PinHook)(boolean low);
+
+class MLX90614WireBus : public MLX90614Bus {
+public:
+    MLX90614WireBus() : _wakeHook(NULL) {}
+
+    uint8_t  sendCommand(uint8_t addr, uint8_t cmd);
+    uint8_t  receive(uint8_t addr, uint8_t* buf, uint8_t len);
+    uint8_t  transmit(uint8_t addr, const uint8_t* buf, uint8_t len);
+    uint16_t turnaround(void);
+    boolean  wakeLine(boolean low);
+    void     setWakeHook(MLX90614PinHook hook) {_wakeHook = hook;}  /**< Enable wake up */
+
+private:
+    MLX90614PinHook _wakeHook;
+};
+
+extern MLX90614WireBus MLX90614Wire;                        /**< Default transport (Wire library) */
+
+#endif /* _MLX90614BUS_H_ */
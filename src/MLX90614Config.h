@@ -0,0 +1,55 @@
+#ifndef _MLX90614CONFIG_H_
+#define _MLX90614CONFIG_H_
+
+/***********************************************************************************************//**
+ *  \brief      Melexis MLX90614 Family Device Driver Library - Build configuration.
+ *  \par
+ *  \par        Details
+ *              Options that change the layout of the MLX90614 class. They must be the same for
+ *              the library sources and for every file that uses the class, so they are set here
+ *              for the whole library.
+ *  \li         Edit this file to change them. A build system that passes the same -D option to
+ *              every file (library and sketch) may also be used.
+ *  \li         Do NOT define them in a sketch before including MLX90614.h. The Arduino IDE
+ *              compiles the library without the sketch's defines, the sketch would then see a
+ *              different object than the library builds.
+ *
+ *  \file       MLX90614CONFIG.H
+ *  \author     J. F. Fitter <jfitter@eagleairaust.com.au>
+ *  \version    1.0
+ *  \date       2014-2017
+ *  \copyright  Copyright &copy; 2017 John Fitter.  All right reserved.
+ *
+ *  \par        License
+ *              This program is free software; you can redistribute it and/or modify it under
+ *              the terms of the GNU Lesser General Public License as published by the Free
+ *              Software Foundation; either version 2.1 of the License, or (at your option)
+ *              any later version.
+ *  \par
+ *              This Program is distributed in the hope that it will be useful, but WITHOUT ANY
+ *              WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *              PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details
+ *              at http://www.gnu.org/copyleft/gpl.html
+ *  \par
+ *              You should have received a copy of the GNU Lesser General Public License along
+ *              with this library; if not, write to the Free Software Foundation, Inc.,
+ *              51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *//***********************************************************************************************/
+
+#ifndef MLX90614_EESHADOW
+#define MLX90614_EESHADOW       1       /**< Keep a shadow copy of the EEPROM in RAM (68 bytes).
+                                             0 to save RAM, getters then read the device every
+                                             time. */
+#endif
+
+#ifndef MLX90614_THROTTLE
+#define MLX90614_THROTTLE       0       /**< 1 to keep the last sample of each RAM register for
+                                             read throttling, see setThrottle() (44 bytes). */
+#endif
+
+#ifndef MLX90614_STATS
+#define MLX90614_STATS          0       /**< 1 to keep transaction statistics (256 bytes). */
+#endif
+
+#endif /* _MLX90614CONFIG_H_ */
@@ -0,0 +1,154 @@
+/***********************************************************************************************//**
+ *  \brief      Melexis MLX90614 Family Device Driver Library - Duty cycled sampling CPP Source file.
+ *  \file       MLX90614DUTYCYCLE.CPP
+ *  \author     J. F. Fitter <jfitter@eagleairaust.com.au>
+ *  \version    1.0
+ *  \date       2014-2017
+ *  \copyright  Copyright &copy; 2017 John Fitter.  All right reserved.
+ *
+ *  \par        License
+ *              This program is free software; you can redistribute it and/or modify it under
+ *              the terms of the GNU Lesser General Public License as published by the Free
+ *              Software Foundation; either version 2.1 of the License, or (at your option)
+ *              any later version.
+ *  \par
+ *              This Program is distributed in the hope that it will be useful, but WITHOUT ANY
+ *              WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *              PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details
+ *              at http://www.gnu.org/copyleft/gpl.html
+ *  \par
+ *              You should have received a copy of the GNU Lesser General Public License along
+ *              with this library; if not, write to the Free Software Foundation, Inc.,
+ *              51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *//***********************************************************************************************/
+
+#include "MLX90614DutyCycle.h"
+
+/** Scheduler states. */
+enum {DC_FIRST, DC_ASLEEP, DC_WAKELOW, DC_INIT, DC_AWAKE, DC_INVALID};
+
+/**************************************************************************************************/
+/*  MLX90614 Duty cycled sampling functions.                                                      */
+/**************************************************************************************************/
+
+/**
+ *  \brief             Duty cycled sampling constructor.
+ *  \param [in] dev    Device to sample. It is assumed to be awake.
+ *  \param [in] period Sampling period (us), at least MLX90614_TWAKELOW + MLX90614_TINITMAX.
+ *  \param [in] reg    RAM register to read (MLX90614_RAWIR1 to MLX90614_TOBJ2), default
+ *                     MLX90614_TOBJ1. Any other register sets MLX90614_INVALIDATA in error() and
+ *                     poll() does nothing but return MLX90614_IDLE.
+ */
+MLX90614DutyCycle::MLX90614DutyCycle(MLX90614& dev, uint32_t period, uint8_t reg) {
+
+    _dev = &dev;
+    _period = period;
+    _reg = reg;
+    _canSleep = _asleep = false;
+    _noFlags = false;
+    _raw = 0;
+    _due = _tWake = _tPoll = _t0 = 0;
+    _stamp = _cycles = _wakeLat = _awake = _polls = _awakeTotal = 0;
+    if((reg < MLX90614_RAWIR1) || (reg > MLX90614_TOBJ2)) {
+        _state = DC_INVALID;
+        _err = MLX90614_INVALIDATA;
+    } else {
+        _state = DC_FIRST;
+        _err = 0;
+    }
+}
+
+/**
+ *  \brief             Advance the schedule. Performs at most one bus transaction per call.
+ *  \return            MLX90614_DONE when a new sample is available, otherwise MLX90614_PENDING
+ *                     while awake or MLX90614_IDLE while asleep.
+ */
+MLX90614::pollStat_t MLX90614DutyCycle::poll(void) {
+    uint32_t now = micros();
+
+    switch(_state) {
+
+        // Sample straight away, the device starts awake. A short SDA pulse (a start and stop
+        // condition to the devices) tells whether the transport can wake the device at all.
+        case DC_FIRST :
+            _canSleep = _dev->wakeStart();
+            if(_canSleep) _dev->wakeEnd();
+            _t0 = _due = _tWake = now;
+            _wakeLat = 0;
+            sample(now);
+            return MLX90614::MLX90614_DONE;
+
+        case DC_ASLEEP :
+            if((int32_t)(now - _due) < 0) return MLX90614::MLX90614_IDLE;
+            _tWake = now;
+            _polls = 0;
+            _noFlags = false;
+            if(!_asleep) {
+                _wakeLat = 0;
+                sample(now);
+                return MLX90614::MLX90614_DONE;
+            }
+            _dev->wakeStart();
+            _state = DC_WAKELOW;
+            return MLX90614::MLX90614_PENDING;
+
+        case DC_WAKELOW :
+            if((uint32_t)(now - _tWake) < MLX90614_TWAKELOW) return MLX90614::MLX90614_PENDING;
+            _dev->wakeEnd();
+            _tPoll = now;
+            _state = DC_INIT;
+            return MLX90614::MLX90614_PENDING;
+
+        // Wait for the INIT flag, or the worst case time if it cannot be read.
+        case DC_INIT :
+            if(_noFlags) {
+                if((uint32_t)(now - _tWake) < MLX90614_TWAKELOW + MLX90614_TINITMAX)
+                    return MLX90614::MLX90614_PENDING;
+            } else {
+                if((uint32_t)(now - _tPoll) < MLX90614_TINITPOLL) return MLX90614::MLX90614_PENDING;
+                _tPoll = now;
+                ++_polls;
+                boolean done = _dev->initDone();
+                if(_dev->rwError) {
+                    if((uint32_t)(now - _tWake) >= MLX90614_TWAKELOW + MLX90614_TINITMAX) _noFlags = true;
+                    return MLX90614::MLX90614_PENDING;
+                }
+                if(!done) return MLX90614::MLX90614_PENDING;
+            }
+            _wakeLat = now - _tWake;
+            sample(now);
+            return MLX90614::MLX90614_DONE;
+    }
+    return MLX90614::MLX90614_IDLE;
+}
+
+/**
+ *  \brief             Read the register, put the device to sleep and schedule the next cycle.
+ */
+void MLX90614DutyCycle::sample(uint32_t now) {
+    MLX90614::snapshot_t snap;
+    uint8_t ch = _reg - MLX90614_RAWIR1;
+
+    _err = _dev->readAll(snap, 1 << ch);
+    _raw = snap.raw[ch];
+    _stamp = now;
+    ++_cycles;
+    _asleep = _canSleep && _dev->sleep();
+    _awake = micros() - _tWake;
+    _awakeTotal += _awake;
+    _due += _period;
+    if((int32_t)(micros() - _due) > 0) _due = micros();
+    _state = DC_ASLEEP;
+}
+
+/**
+ *  \brief             Fraction of the time since the first sample that the device was awake.
+ *                     1.0 until the first sample has been taken.
+ */
+float MLX90614DutyCycle::dutyCycle(void) {
+    if(!_canSleep || !_cycles) return 1.0;
+
+    uint32_t t = micros() - _t0;
+    return t ? (float)_awakeTotal / t : 1.0;
+}
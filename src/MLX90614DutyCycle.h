@@ -0,0 +1,90 @@
+#ifndef _MLX90614DUTYCYCLE_H_
+#define _MLX90614DUTYCYCLE_H_
+
+/***********************************************************************************************//**
+ *  \brief      Melexis MLX90614 Family Device Driver Library - Duty cycled sampling.
+ *  \par
+ *  \par        Details
+ *              Keeps a device in sleep mode between samples. Once per period the device is woken,
+ *              the INIT flag is polled until the power on initialization has finished, one
+ *              register is read and the device is put back to sleep. Call poll() from the main
+ *              loop, it never blocks.
+ *  \li         The wait after wake up ends at the first valid sample rather than after a worst
+ *              case delay. If the flags register cannot be read the scheduler falls back to
+ *              MLX90614_TINITMAX for that cycle, the flags are tried again at the next wake up.
+ *  \li         Reports the wake latency (start of wake up to INIT done), the time awake per cycle
+ *              and the overall fraction of time awake, for energy estimates.
+ *  \li         The transport must support wake up (MLX90614Bus::wakeLine()), otherwise the device
+ *              is left awake and simply read once per period.
+ *  \li         Waking drives the bus, other devices on it are woken too.
+ *
+ *  \file       MLX90614DUTYCYCLE.H
+ *  \author     J. F. Fitter <jfitter@eagleairaust.com.au>
+ *  \version    1.0
+ *  \date       2014-2017
+ *  \copyright  Copyright &copy; 2017 John Fitter.  All right reserved.
+ *
+ *  \par        License
+ *              This program is free software; you can redistribute it and/or modify it under
+ *              the terms of the GNU Lesser General Public License as published by the Free
+ *              Software Foundation; either version 2.1 of the License, or (at your option)
+ *              any later version.
+ *  \par
+ *              This Program is distributed in the hope that it will be useful, but WITHOUT ANY
+ *              WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *              PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details
+ *              at http://www.gnu.org/copyleft/gpl.html
+ *  \par
+ *              You should have received a copy of the GNU Lesser General Public License along
+ *              with this library; if not, write to the Free Software Foundation, Inc.,
+ *              51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *//***********************************************************************************************/
+
+#include "MLX90614.h"
+
+/**************************************************************************************************/
+/* MLX90614 Duty cycled sampling class.                                                           */
+/**************************************************************************************************/
+
+class MLX90614DutyCycle {
+public:
+    MLX90614DutyCycle(MLX90614& dev, uint32_t period, uint8_t reg = MLX90614_TOBJ1);
+
+    MLX90614::pollStat_t poll(void);                        /**< Run, MLX90614_DONE on a new sample */
+
+    uint16_t raw(void)          {return _raw;}              /**< Last raw value */
+    uint8_t  error(void)        {return _err;}              /**< Last R/W error flags */
+    uint32_t timestamp(void)    {return _stamp;}            /**< Last sample time (us) */
+    uint32_t cycles(void)       {return _cycles;}           /**< Samples taken */
+    uint32_t wakeLatency(void)  {return _wakeLat;}          /**< Last wake up to INIT done (us) */
+    uint32_t awakeTime(void)    {return _awake;}            /**< Last wake up to sleep (us) */
+    uint32_t flagPolls(void)    {return _polls;}            /**< Flags reads in the last cycle */
+    boolean  sleeping(void)     {return _asleep;}           /**< Device is in sleep mode */
+    float    dutyCycle(void);                               /**< Fraction of time awake */
+
+private:
+    MLX90614* _dev;
+    uint32_t _period;
+    uint8_t  _reg;
+    uint8_t  _state;
+    boolean  _canSleep;                                     /**< Transport supports wake up */
+    boolean  _asleep;                                       /**< Sleep command accepted */
+    boolean  _noFlags;                                      /**< Flags not readable this cycle */
+    uint8_t  _err;
+    uint16_t _raw;
+    uint32_t _due;                                          /**< Next cycle start (us) */
+    uint32_t _tWake;                                        /**< Cycle wake up start (us) */
+    uint32_t _tPoll;                                        /**< Last flags read (us) */
+    uint32_t _stamp;
+    uint32_t _cycles;
+    uint32_t _wakeLat;
+    uint32_t _awake;
+    uint32_t _polls;
+    uint32_t _t0;                                           /**< First cycle start (us) */
+    uint32_t _awakeTotal;                                   /**< Time awake, all cycles (us) */
+
+    void     sample(uint32_t now);
+};
+
+#endif /* _MLX90614DUTYCYCLE_H_ */
@@ -0,0 +1,108 @@
+/***********************************************************************************************//**
+ *  \brief      Melexis MLX90614 Family Device Driver Library - Background EEPROM write queue.
+ *  \file       MLX90614EEQUEUE.CPP
+ *  \author     J. F. Fitter <jfitter@eagleairaust.com.au>
+ *  \version    1.0
+ *  \date       2014-2017
+ *  \copyright  Copyright &copy; 2017 John Fitter.  All right reserved.
+ *
+ *  \par        License
+ *              This program is free software; you can redistribute it and/or modify it under
+ *              the terms of the GNU Lesser General Public License as published by the Free
+ *              Software Foundation; either version 2.1 of the License, or (at your option)
+ *              any later version.
+ *  \par
+ *              This Program is distributed in the hope that it will be useful, but WITHOUT ANY
+ *              WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *              PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details
+ *              at http://www.gnu.org/copyleft/gpl.html
+ *  \par
+ *              You should have received a copy of the GNU Lesser General Public License along
+ *              with this library; if not, write to the Free Software Foundation, Inc.,
+ *              51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *//***********************************************************************************************/
+
+#include "MLX90614EEQueue.h"
+
+/** Entry states. */
+enum {EEQ_EMPTY, EEQ_QUEUED, EEQ_BUSY, EEQ_DONE};
+
+/**************************************************************************************************/
+/*  MLX90614 EEPROM write queue functions.                                                        */
+/**************************************************************************************************/
+
+/**
+ *  \brief            EEPROM write queue constructor.
+ *  \param [in] dev   Device to write to.
+ */
+MLX90614EEQueue::MLX90614EEQueue(MLX90614& dev) {
+
+    _dev = &dev;
+    _head = _tail = _count = _seq = 0;
+    for(uint8_t i = 0; i < MLX90614_EEQUEUELEN; i++) _q[i].state = EEQ_EMPTY;
+}
+
+/**
+ *  \brief              Queue an EEPROM write.
+ *  \param [in] reg     EEPROM address to write to.
+ *  \param [in] data    Value to write.
+ *  \param [out] ticket Optional - receives the ticket for status().
+ *  \return             False if the queue is full.
+ */
+boolean MLX90614EEQueue::push(uint8_t reg, uint16_t data, uint8_t* ticket) {
+
+    if(_count >= MLX90614_EEQUEUELEN) return false;
+    entry_t& e = _q[_tail];
+    e.ticket = _seq++;
+    e.reg = reg;
+    e.data = data;
+    e.err = 0;
+    e.state = EEQ_QUEUED;
+    if(ticket) *ticket = e.ticket;
+    _tail = (_tail + 1) % MLX90614_EEQUEUELEN;
+    ++_count;
+    return true;
+}
+
+/**
+ *  \brief            Advance the queue by at most one bus transaction.
+ *  \return           True while writes are outstanding.
+ */
+boolean MLX90614EEQueue::poll(void) {
+
+    if(!_count) return false;
+    entry_t& e = _q[_head];
+
+    // Start the write. The device engine may be in use by a blocking writeEEProm().
+    if(e.state == EEQ_QUEUED) {
+        if(!_dev->eeStart(e.reg, e.data)) return true;
+        e.state = EEQ_BUSY;
+    }
+    if(_dev->eePoll() != MLX90614::MLX90614_PENDING) {
+        e.err = _dev->rwError;
+        e.state = EEQ_DONE;
+        _head = (_head + 1) % MLX90614_EEQUEUELEN;
+        --_count;
+    }
+    return _count != 0;
+}
+
+/**
+ *  \brief            Return the status of a queued write.
+ *  \param [in] ticket Ticket returned by push().
+ *  \param [out] err  Optional - receives the R/W error flags of a completed write
+ *                    (MLX90614_EECORRUPT if the EEPROM is likely to be corrupted).
+ *  \return           MLX90614_PENDING, MLX90614_DONE, or MLX90614_IDLE if the ticket is unknown.
+ */
+MLX90614::pollStat_t MLX90614EEQueue::status(uint8_t ticket, uint8_t* err) {
+
+    for(uint8_t i = 0; i < MLX90614_EEQUEUELEN; i++) {
+        entry_t& e = _q[i];
+        if((e.state == EEQ_EMPTY) || (e.ticket != ticket)) continue;
+        if(e.state != EEQ_DONE) return MLX90614::MLX90614_PENDING;
+        if(err) *err = e.err;
+        return MLX90614::MLX90614_DONE;
+    }
+    return MLX90614::MLX90614_IDLE;
+}
@@ -0,0 +1,73 @@
+#ifndef _MLX90614EEQUEUE_H_
+#define _MLX90614EEQUEUE_H_
+
+/***********************************************************************************************//**
+ *  \brief      Melexis MLX90614 Family Device Driver Library - Background EEPROM write queue.
+ *  \par
+ *  \par        Details
+ *              Queues EEPROM writes for one device and drives them with the device's
+ *              non-blocking eeStart()/eePoll() engine from the main loop. Each queued write gets
+ *              a ticket that can be used to look up its completion and R/W error flags.
+ *  \li         Call poll() regularly. Each call performs at most one bus transaction.
+ *  \li         With one queue per device, writes to several devices proceed concurrently.
+ *  \li         Results are kept until the slot is reused, MLX90614_EEQUEUELEN writes later.
+ *
+ *  \file       MLX90614EEQUEUE.H
+ *  \author     J. F. Fitter <jfitter@eagleairaust.com.au>
+ *  \version    1.0
+ *  \date       2014-2017
+ *  \copyright  Copyright &copy; 2017 John Fitter.  All right reserved.
+ *
+ *  \par        License
+ *              This program is free software; you can redistribute it and/or modify it under
+ *              the terms of the GNU Lesser General Public License as published by the Free
+ *              Software Foundation; either version 2.1 of the License, or (at your option)
+ *              any later version.
+ *  \par
+ *              This Program is distributed in the hope that it will be useful, but WITHOUT ANY
+ *              WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *              PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details
+ *              at http://www.gnu.org/copyleft/gpl.html
+ *  \par
+ *              You should have received a copy of the GNU Lesser General Public License along
+ *              with this library; if not, write to the Free Software Foundation, Inc.,
+ *              51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *//***********************************************************************************************/
+
+#include "MLX90614.h"
+
+#define MLX90614_EEQUEUELEN     4       /**< EEPROM write queue length */
+
+/**************************************************************************************************/
+/* MLX90614 EEPROM write queue class.                                                             */
+/**************************************************************************************************/
+
+class MLX90614EEQueue {
+public:
+    MLX90614EEQueue(MLX90614& dev);
+
+    boolean  push(uint8_t reg, uint16_t data, uint8_t* ticket = NULL);
+    boolean  poll(void);
+    boolean  busy(void) {return _count != 0;}               /**< Writes are outstanding */
+    MLX90614::pollStat_t status(uint8_t ticket, uint8_t* err = NULL);
+
+private:
+    /** Queue entry. */
+    struct entry_t {
+        uint8_t  ticket;
+        uint8_t  reg;
+        uint8_t  state;
+        uint8_t  err;
+        uint16_t data;
+    };
+
+    MLX90614* _dev;
+    entry_t  _q[MLX90614_EEQUEUELEN];
+    uint8_t  _head;                                         /**< Entry being written */
+    uint8_t  _tail;                                         /**< Next free entry */
+    uint8_t  _count;                                        /**< Outstanding entries */
+    uint8_t  _seq;                                          /**< Next ticket */
+};
+
+#endif /* _MLX90614EEQUEUE_H_ */
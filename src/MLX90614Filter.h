@@ -0,0 +1,256 @@
+#ifndef _MLX90614FILTER_H_
+#define _MLX90614FILTER_H_
+
+/***********************************************************************************************//**
+ *  \brief      Melexis MLX90614 Family Device Driver Library - Sample filter chain.
+ *  \par
+ *  \par        Details
+ *              Software smoothing of temperature samples, so the device can be run with short
+ *              IIR/FIR settings (fast settling) and the noise removed in firmware. Filters can be
+ *              retuned at any time without EEPROM writes.
+ *  \li         Every stage keeps fixed size state and uses no heap.
+ *  \li         Moving average, exponential and Kalman stages update in constant time. The moving
+ *              average keeps a compensated (Kahan-Babuska) running sum, so float rounding does
+ *              not accumulate over long runs. The median stage moves one element of its sorted
+ *              window, O(N) for a small fixed N.
+ *  \li         The first sample after construction or reset() primes the stage (output = input).
+ *  \li         MLX90614FilterChain runs up to N stages in order, eg. median then exponential.
+ *
+ *  \file       MLX90614FILTER.H
+ *  \author     J. F. Fitter <jfitter@eagleairaust.com.au>
+ *  \version    1.0
+ *  \date       2014-2017
+ *  \copyright  Copyright &copy; 2017 John Fitter.  All right reserved.
+ *
+ *  \par        License
+ *              This program is free software; you can redistribute it and/or modify it under
+ *              the terms of the GNU Lesser General Public License as published by the Free
+ *              Software Foundation; either version 2.1 of the License, or (at your option)
+ *              any later version.
+ *  \par
+ *              This Program is distributed in the hope that it will be useful, but WITHOUT ANY
+ *              WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *              PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details
+ *              at http://www.gnu.org/copyleft/gpl.html
+ *  \par
+ *              You should have received a copy of the GNU Lesser General Public License along
+ *              with this library; if not, write to the Free Software Foundation, Inc.,
+ *              51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *//***********************************************************************************************/
+
+#include "MLX90614.h"
+
+/**************************************************************************************************/
+/* MLX90614 Filter stage interface.                                                               */
+/**************************************************************************************************/
+
+class MLX90614Filter {
+public:
+    virtual ~MLX90614Filter() {}
+
+    /** Add a sample and return the filtered value. */
+    virtual float update(float x) = 0;
+
+    /** Discard the history, the next sample primes the filter. */
+    virtual void  reset(void) = 0;
+};
+
+/**************************************************************************************************/
+/* Moving average of the last N samples.                                                          */
+/**************************************************************************************************/
+
+template<uint8_t N> class MLX90614MovingAvg : public MLX90614Filter {
+    static_assert(N, "Window must hold at least 1 sample");
+public:
+    MLX90614MovingAvg() {reset();}
+
+    float update(float x) {
+
+        if(_n < N) ++_n;
+        else add(-_buf[_i]);
+        _buf[_i] = x;
+        add(x);
+        if(++_i >= N) _i = 0;
+        return (_sum + _c) / _n;
+    }
+
+    void  reset(void) {_n = _i = 0; _sum = _c = 0;}
+
+private:
+    float    _buf[N];
+    float    _sum;                                          /**< Sum of the samples in the window */
+    float    _c;                                            /**< Rounding error lost from _sum */
+    uint8_t  _n;                                            /**< Samples in the window */
+    uint8_t  _i;                                            /**< Oldest sample once the window is full */
+
+    /** Compensated addition, the low order bits lost from the sum are kept in _c. */
+    void  add(float v) {
+        float t = _sum + v;
+
+        if(fabs(_sum) >= fabs(v)) _c += (_sum - t) + v;
+        else _c += (v - t) + _sum;
+        _sum = t;
+    }
+};
+
+/**************************************************************************************************/
+/* Running median of the last N samples (N odd).                                                  */
+/**************************************************************************************************/
+
+template<uint8_t N> class MLX90614Median : public MLX90614Filter {
+    static_assert((N & 1) && (N < 64), "Window must be odd, at most 63 samples");
+public:
+    MLX90614Median() {reset();}
+
+    /** Rejects isolated spikes (eg. a read error) that an average would smear into the output. */
+    float update(float x) {
+        uint8_t j;
+
+        if(_n < N) j = _n++;
+        else {
+            // Remove the oldest sample from the sorted window.
+            float old = _age[_i];
+            for(j = 0; (j < N - 1) && (_sort[j] != old); j++) ;
+            for(; j < N - 1; j++) _sort[j] = _sort[j + 1];
+        }
+        _age[_i] = x;
+        if(++_i >= N) _i = 0;
+
+        // Insert the new sample.
+        for(; j && (_sort[j - 1] > x); j--) _sort[j] = _sort[j - 1];
+        _sort[j] = x;
+        return _sort[(_n - 1) >> 1];
+    }
+
+    void  reset(void) {_n = _i = 0;}
+
+private:
+    float    _age[N];                                       /**< Samples in arrival order */
+    float    _sort[N];                                      /**< Samples in ascending order */
+    uint8_t  _n;                                            /**< Samples in the window */
+    uint8_t  _i;                                            /**< Oldest sample once the window is full */
+};
+
+/**************************************************************************************************/
+/* Exponential smoothing (single pole low pass).                                                  */
+/**************************************************************************************************/
+
+class MLX90614ExpFilter : public MLX90614Filter {
+public:
+    /**
+     *  \brief             Exponential filter constructor.
+     *  \param [in] alpha  Weight of the new sample 0 < alpha <= 1 (1 = no filtering).
+     */
+    MLX90614ExpFilter(float alpha = 0.25) : _alpha(alpha), _primed(false) {}
+
+    float update(float x) {
+
+        if(!_primed) {
+            _primed = true;
+            return _y = x;
+        }
+        return _y += _alpha * (x - _y);
+    }
+
+    void  reset(void) {_primed = false;}
+    void  setAlpha(float alpha) {_alpha = alpha;}           /**< Retune, the output is kept */
+    float getAlpha(void)        {return _alpha;}
+
+private:
+    float    _alpha;
+    float    _y;
+    boolean  _primed;
+};
+
+/**************************************************************************************************/
+/* One dimensional Kalman filter (constant temperature model).                                    */
+/**************************************************************************************************/
+
+class MLX90614Kalman : public MLX90614Filter {
+public:
+    /**
+     *  \brief             Kalman filter constructor.
+     *  \param [in] q      Process noise variance per sample (how fast the temperature may move).
+     *  \param [in] r      Measurement noise variance (sensor noise squared).
+     */
+    MLX90614Kalman(float q = 0.001, float r = 0.04) : _q(q), _r(r), _primed(false) {}
+
+    float update(float x) {
+
+        if(!_primed) {
+            _primed = true;
+            _p = _r;
+            return _x = x;
+        }
+        _p += _q;
+        float k = _p / (_p + _r);
+        _x += k * (x - _x);
+        _p *= 1 - k;
+        return _x;
+    }
+
+    void  reset(void) {_primed = false;}
+    void  setNoise(float q, float r) {_q = q; _r = r;}      /**< Retune, the estimate is kept */
+    float variance(void) {return _p;}                       /**< Estimate error variance */
+
+private:
+    float    _q;
+    float    _r;
+    float    _x;                                            /**< Estimate */
+    float    _p;                                            /**< Estimate error variance */
+    boolean  _primed;
+};
+
+/**************************************************************************************************/
+/* MLX90614 Filter chain class.                                                                   */
+/**************************************************************************************************/
+
+template<uint8_t N> class MLX90614FilterChain : public MLX90614Filter {
+public:
+    MLX90614FilterChain() : _n(0), _last(NAN) {}
+
+    /**
+     *  \brief             Append a stage. The stage is not copied and must outlive the chain.
+     *  \return            False if the chain is full.
+     */
+    boolean add(MLX90614Filter& stage) {
+
+        if(_n >= N) return false;
+        _stage[_n++] = &stage;
+        return true;
+    }
+
+    float update(float x) {
+        for(uint8_t i = 0; i < _n; i++) x = _stage[i]->update(x);
+        return x;
+    }
+
+    void  reset(void) {
+        for(uint8_t i = 0; i < _n; i++) _stage[i]->reset();
+        _last = NAN;
+    }
+
+    /**
+     *  \brief             Read a temperature and filter it. Samples with R/W errors are not
+     *                     filtered, the last output is returned instead (NAN until the first
+     *                     good sample has primed the chain).
+     *  \param [in] dev    Device to read.
+     *  \param [in] tsrc   Internal temperature source to read, default #1.
+     *  \param [in] tunit  Temperature units, default &deg;C.
+     *  \return            Filtered temperature.
+     */
+    float read(MLX90614& dev, MLX90614::tempSrc_t tsrc = MLX90614::MLX90614_SRC01,
+               MLX90614::tempUnit_t tunit = MLX90614::MLX90614_TC) {
+        float t = dev.readTemp(tsrc, tunit);
+
+        return dev.rwError ? _last : _last = update(t);
+    }
+
+private:
+    MLX90614Filter* _stage[N];
+    uint8_t  _n;
+    float    _last;                                         /**< Last output, NAN until primed */
+};
+
+#endif /* _MLX90614FILTER_H_ */
@@ -0,0 +1,130 @@
+/***********************************************************************************************//**
+ *  \brief      Melexis MLX90614 Family Device Driver Library - Multi-sensor bus manager.
+ *  \file       MLX90614MANAGER.CPP
+ *  \author     J. F. Fitter <jfitter@eagleairaust.com.au>
+ *  \version    1.0
+ *  \date       2014-2017
+ *  \copyright  Copyright &copy; 2017 John Fitter.  All right reserved.
+ *
+ *  \par        License
+ *              This program is free software; you can redistribute it and/or modify it under
+ *              the terms of the GNU Lesser General Public License as published by the Free
+ *              Software Foundation; either version 2.1 of the License, or (at your option)
+ *              any later version.
+ *  \par
+ *              This Program is distributed in the hope that it will be useful, but WITHOUT ANY
+ *              WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *              PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details
+ *              at http://www.gnu.org/copyleft/gpl.html
+ *  \par
+ *              You should have received a copy of the GNU Lesser General Public License along
+ *              with this library; if not, write to the Free Software Foundation, Inc.,
+ *              51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *//***********************************************************************************************/
+
+#include "MLX90614Manager.h"
+
+/**************************************************************************************************/
+/*  MLX90614 Multi-sensor manager functions.                                                      */
+/**************************************************************************************************/
+
+/**
+ *  \brief  Multi-sensor manager constructor.
+ */
+MLX90614Manager::MLX90614Manager() {
+
+    _n = _next = 0;
+    _active = _last = -1;
+    resetStats();
+}
+
+/**
+ *  \brief              Add a device to the schedule.
+ *  \param [in] dev     Device. Must have a unique address and stay in scope.
+ *  \param [in] reg     RAM register to read, default MLX90614_TOBJ1.
+ *  \param [in] period  Read period in microseconds, default (0) the device refresh period.
+ *  \return             False if the manager is full.
+ */
+boolean MLX90614Manager::add(MLX90614& dev, uint8_t reg, uint32_t period) {
+
+    if(_n >= MLX90614_MAXDEVICES) return false;
+    slot_t& s = _slot[_n++];
+    s.dev = &dev;
+    s.reg = reg;
+    s.period = period ? period : dev.dataPeriod();
+    s.due = micros();
+    s.raw = 0;
+    s.err = 0;
+    s.last = s.stale = s.samples = 0;
+    return true;
+}
+
+/**
+ *  \brief  Clear the statistics.
+ */
+void MLX90614Manager::resetStats(void) {
+
+    _t0 = micros();
+    _total = 0;
+    for(uint8_t i = 0; i < _n; i++) _slot[i].stale = _slot[i].samples = 0;
+}
+
+/**
+ *  \brief  Return the aggregate number of samples per second since the statistics were reset.
+ */
+float MLX90614Manager::sampleRate(void) {
+    uint32_t dt = micros() - _t0;
+
+    return dt ? _total * 1e6 / dt : 0;
+}
+
+/**
+ *  \brief  Advance the schedule. Call as often as possible.
+ *  \return True when a sample has completed, see last().
+ */
+boolean MLX90614Manager::poll(void) {
+
+    if(_active < 0) {
+        startNext(micros());
+        return false;
+    }
+
+    slot_t& s = _slot[_active];
+    if(s.dev->poll() == MLX90614::MLX90614_PENDING) return false;
+    s.raw = s.dev->rawResult();
+    s.err = s.dev->rwError;
+    _last = _active;
+    _active = -1;
+
+    // Get the next read under way before the bookkeeping.
+    uint32_t now = micros();
+    startNext(now);
+
+    if(s.samples && ((uint32_t)(now - s.last) > s.stale)) s.stale = now - s.last;
+    s.last = now;
+    ++s.samples;
+    ++_total;
+    return true;
+}
+
+/**
+ *  \brief             Start a read on the next due device, round robin.
+ *  \param [in] now    Current time (us).
+ */
+void MLX90614Manager::startNext(uint32_t now) {
+
+    for(uint8_t k = 0; k < _n; k++) {
+        uint8_t i = (_next + k) % _n;
+        slot_t& s = _slot[i];
+        if((int32_t)(now - s.due) < 0) continue;
+        if(!s.dev->startReadRaw(s.reg)) continue;
+
+        // Keep the schedule, unless it has fallen more than a period behind.
+        s.due += s.period;
+        if((int32_t)(now - s.due) >= 0) s.due = now + s.period;
+        _active = i;
+        _next = i + 1;
+        return;
+    }
+}
@@ -0,0 +1,93 @@
+#ifndef _MLX90614MANAGER_H_
+#define _MLX90614MANAGER_H_
+
+/***********************************************************************************************//**
+ *  \brief      Melexis MLX90614 Family Device Driver Library - Multi-sensor bus manager.
+ *  \par
+ *  \par        Details
+ *              Schedules reads of several devices (on distinct addresses) sharing one bus, using
+ *              the asynchronous read of each device. Call poll() from the main loop.
+ *  \li         Each device is read once per period, by default its data refresh period
+ *              (MLX90614::dataPeriod()), so no bus time is spent re-reading unchanged data.
+ *  \li         Due devices are served round robin. The next device's read is started as soon
+ *              as the previous one completes, and the completed sample is then processed while
+ *              the new read's turnaround delay runs. SMBus allows only one transaction at a time
+ *              so reads of different devices cannot overlap on the wire.
+ *  \li         Reports aggregate samples per second and the worst case staleness (longest
+ *              interval between successive samples) per device.
+ *
+ *  \file       MLX90614MANAGER.H
+ *  \author     J. F. Fitter <jfitter@eagleairaust.com.au>
+ *  \version    1.0
+ *  \date       2014-2017
+ *  \copyright  Copyright &copy; 2017 John Fitter.  All right reserved.
+ *
+ *  \par        License
+ *              This program is free software; you can redistribute it and/or modify it under
+ *              the terms of the GNU Lesser General Public License as published by the Free
+ *              Software Foundation; either version 2.1 of the License, or (at your option)
+ *              any later version.
+ *  \par
+ *              This Program is distributed in the hope that it will be useful, but WITHOUT ANY
+ *              WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *              PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details
+ *              at http://www.gnu.org/copyleft/gpl.html
+ *  \par
+ *              You should have received a copy of the GNU Lesser General Public License along
+ *              with this library; if not, write to the Free Software Foundation, Inc.,
+ *              51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *//***********************************************************************************************/
+
+#include "MLX90614.h"
+
+#define MLX90614_MAXDEVICES     16      /**< Maximum number of devices per manager */
+
+/**************************************************************************************************/
+/* MLX90614 Multi-sensor manager class.                                                           */
+/**************************************************************************************************/
+
+class MLX90614Manager {
+public:
+    MLX90614Manager();
+
+    boolean  add(MLX90614& dev, uint8_t reg = MLX90614_TOBJ1, uint32_t period = 0);
+    boolean  poll(void);
+    void     resetStats(void);
+
+    uint8_t  count(void)                {return _n;}                    /**< Number of devices */
+    int8_t   last(void)                 {return _last;}                 /**< Last device sampled */
+    uint16_t raw(uint8_t i)             {return _slot[i].raw;}          /**< Last raw value */
+    uint8_t  error(uint8_t i)           {return _slot[i].err;}          /**< Last R/W error flags */
+    uint32_t timestamp(uint8_t i)       {return _slot[i].last;}         /**< Last sample time (us) */
+    uint32_t samples(uint8_t i)         {return _slot[i].samples;}      /**< Samples taken */
+    uint32_t maxStaleness(uint8_t i)    {return _slot[i].stale;}        /**< Worst case staleness (us) */
+    uint32_t totalSamples(void)         {return _total;}                /**< Samples, all devices */
+    float    sampleRate(void);
+
+private:
+    /** Per device schedule and results. */
+    struct slot_t {
+        MLX90614* dev;
+        uint8_t  reg;
+        uint8_t  err;
+        uint16_t raw;
+        uint32_t period;
+        uint32_t due;
+        uint32_t last;
+        uint32_t stale;
+        uint32_t samples;
+    };
+
+    slot_t   _slot[MLX90614_MAXDEVICES];
+    uint8_t  _n;
+    uint8_t  _next;                                         /**< Round robin position */
+    int8_t   _active;                                       /**< Device with a read pending */
+    int8_t   _last;
+    uint32_t _t0;
+    uint32_t _total;
+
+    void     startNext(uint32_t now);
+};
+
+#endif /* _MLX90614MANAGER_H_ */
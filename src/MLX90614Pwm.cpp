@@ -0,0 +1,283 @@
+/***********************************************************************************************//**
+ *  \brief      Melexis MLX90614 Family Device Driver Library - PWM output decoder CPP Source file.
+ *  \file       MLX90614PWM.CPP
+ *  \author     J. F. Fitter <jfitter@eagleairaust.com.au>
+ *  \version    1.0
+ *  \date       2014-2017
+ *  \copyright  Copyright &copy; 2017 John Fitter.  All right reserved.
+ *
+ *  \par        License
+ *              This program is free software; you can redistribute it and/or modify it under
+ *              the terms of the GNU Lesser General Public License as published by the Free
+ *              Software Foundation; either version 2.1 of the License, or (at your option)
+ *              any later version.
+ *  \par
+ *              This Program is distributed in the hope that it will be useful, but WITHOUT ANY
+ *              WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *              PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details
+ *              at http://www.gnu.org/copyleft/gpl.html
+ *  \par
+ *              You should have received a copy of the GNU Lesser General Public License along
+ *              with this library; if not, write to the Free Software Foundation, Inc.,
+ *              51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *//***********************************************************************************************/
+
+#include "MLX90614Pwm.h"
+
+/**************************************************************************************************/
+/*  MLX90614 PWM output decoder functions.                                                        */
+/**************************************************************************************************/
+
+/**
+ *  \brief              PWM decoder constructor. The output range is the factory default.
+ *  \param [in] periods Periods averaged per reading (K), default 1.
+ */
+MLX90614Pwm::MLX90614Pwm(uint8_t periods) {
+
+    _toMin = MLX90614_TOMINDEF;
+    _toMax = MLX90614_TOMAXDEF;
+    _k = periods ? periods : 1;
+    _resK = 1;
+    _resT = 0;
+    _resT2 = 0;
+    _readings = 0;
+    _rejected = 0;
+    _glitches = 0;
+    reset();
+}
+
+/**
+ *  \brief              Set the output temperature range, as stored in the device EEPROM.
+ *  \param [in] toMin   Temperature at the bottom of the data band (centi-Kelvin).
+ *  \param [in] toMax   Temperature at the top of the data band (centi-Kelvin).
+ */
+void MLX90614Pwm::setRange(uint16_t toMin, uint16_t toMax) {
+
+    _toMin = toMin;
+    _toMax = toMax;
+}
+
+/**
+ *  \brief              Read the output temperature range from the device EEPROM.
+ *  \remarks            Typically done once over the SMBus before the device is switched to PWM.
+ *                      The range is left unchanged on a R/W error.
+ *  \param [in] dev     Device to read.
+ *  \return             R/W error flags.
+ */
+uint8_t MLX90614Pwm::readRange(MLX90614& dev) {
+
+    uint16_t toMax = dev.readEEProm(MLX90614_TOMAX);
+    if(dev.rwError) return dev.rwError;
+    uint16_t toMin = dev.readEEProm(MLX90614_TOMIN);
+    if(dev.rwError) return dev.rwError;
+    setRange(toMin, toMax);
+    return MLX90614_NORWERROR;
+}
+
+/**
+ *  \brief              Set the number of periods averaged per reading. Discards the partial sums.
+ *  \param [in] periods Periods per reading (K), 1...255.
+ */
+void MLX90614Pwm::setAverage(uint8_t periods) {
+
+    _k = periods ? periods : 1;
+    _n = 0;
+    _sumT = _sumT2 = 0;
+}
+
+/**
+ *  \brief              Discard the edge history and the partial sums.
+ */
+void MLX90614Pwm::reset(void) {
+
+    _n = 0;
+    _sumT = _sumT2 = 0;
+    _lastT = 0;
+    _bad = 0;
+    _level = false;
+    _haveRise = _haveFall = _haveNext = false;
+    _ready = false;
+}
+
+/**
+ *  \brief              Process one edge of the PWM output.
+ *  \remarks
+ *  \li                 A period is measured rising edge to rising edge, the high time rising edge
+ *                      to falling edge. The period is only taken once the next high pulse has
+ *                      lasted T/16 (the start band is T/8), so a reading completes on the falling
+ *                      edge that follows the last of its K periods.
+ *  \li                 Pulses shorter than T/16 are glitches, both of their edges are ignored.
+ *  \li                 An edge with the same level as the last one means an edge was missed, the
+ *                      period in progress is dropped.
+ *  \param [in] t       Edge timestamp (us), eg. micros(). Wrap around is handled.
+ *  \param [in] level   Pin level after the edge, true for a rising edge.
+ *  \return             True when this edge completed a reading.
+ */
+boolean MLX90614Pwm::edge(uint32_t t, boolean level) {
+    uint32_t tmin = _lastT / 16;
+    boolean done = false;
+
+    if(level == _level) {
+        if(_haveRise) ++_rejected;
+        _haveRise = _haveFall = _haveNext = false;
+    } else if(level) {
+        if(_haveFall && !_haveNext && (uint32_t)(t - _fall) < tmin) {
+            _haveFall = false;                              // Low glitch in the high time
+            ++_glitches;
+        } else if(_haveFall) {
+            _next = t;
+            _haveNext = true;
+        } else {
+            _rise = t;
+            _haveRise = true;
+        }
+    } else if(_haveNext) {
+        if((uint32_t)(t - _next) < tmin) {
+            _haveNext = false;                              // High glitch in the low time
+            ++_glitches;
+        } else {
+            done = accept(_next - _rise, _fall - _rise);
+            _rise = _next;
+            _fall = t;
+            _haveNext = false;
+        }
+    } else if(_haveRise) {
+        _fall = t;
+        _haveFall = true;
+    }
+    _level = level;
+    return done;
+}
+
+/**
+ *  \brief              Validate one period and add it to the sums, complete a reading every K.
+ *  \param [in] T       Period (us).
+ *  \param [in] thigh   High time (us).
+ *  \return             True when this period completed a reading.
+ */
+boolean MLX90614Pwm::accept(uint32_t T, uint32_t thigh) {
+    uint32_t tol = T * MLX90614_PWMTOL / 64;
+
+    // The high time must cover the start band (T/8) and no more than the data band (T/2).
+    if(!T || thigh + tol < T / 8 || thigh > T / 8 + T / 2 + tol ||
+       (_lastT && (T > _lastT + _lastT / 4 || T < _lastT - _lastT / 4))) {
+        ++_rejected;
+        if(++_bad >= MLX90614_PWMRELOCK) _lastT = 0;        // Period really changed, relock
+        return false;
+    }
+    _lastT = T;
+    _bad = 0;
+
+    uint32_t t2 = (thigh > T / 8) ? thigh - T / 8 : 0;
+    if(t2 > T / 2) t2 = T / 2;
+    _sumT += T;
+    _sumT2 += t2;
+    if(++_n < _k) return false;
+
+    // The conversion is left to the readers, no multiply or divide here.
+    _resK = _k;
+    _resT = _sumT;
+    _resT2 = _sumT2;
+    ++_readings;
+    _ready = true;
+    _n = 0;
+    _sumT = _sumT2 = 0;
+    return true;
+}
+
+/**
+ *  \brief              Copy the sums of the last reading, consistent with respect to edge().
+ *  \param [out] sumT   Sum of periods (us).
+ *  \param [out] sumT2  Sum of data band high times (us).
+ *  \param [out] k      Periods summed.
+ *  \param [in] consume True to clear available() in the same critical section.
+ */
+void MLX90614Pwm::result(uint32_t& sumT, uint32_t& sumT2, uint8_t& k, boolean consume) {
+
+    noInterrupts();
+    sumT = _resT;
+    sumT2 = _resT2;
+    k = _resK;
+    if(consume) _ready = false;
+    interrupts();
+}
+
+/**
+ *  \brief              Convert the sums of a reading to centi-Kelvin, 0 before the first reading.
+ *  \remarks            To = 2 (t2/T) (To_max - To_min) + To_min, rounded, on the sums of K periods.
+ */
+int32_t MLX90614Pwm::convert(uint32_t sumT, uint32_t sumT2) {
+
+    if(!sumT) return 0;
+    int32_t range = (int32_t)_toMax - _toMin;
+    int64_t num = 2 * (int64_t)sumT2 * range;
+    num += (num < 0) ? -(int64_t)(sumT / 2) : (int64_t)(sumT / 2);
+    return (int32_t)(num / (int64_t)sumT) + _toMin;
+}
+
+/**
+ *  \brief              Copy a counter written by edge().
+ */
+uint32_t MLX90614Pwm::load(volatile uint32_t& v) {
+
+    noInterrupts();
+    uint32_t x = v;
+    interrupts();
+    return x;
+}
+
+/**
+ *  \brief              Return the last reading in centi-Kelvin, 0 before the first reading.
+ */
+int32_t MLX90614Pwm::centiK(void) {
+    uint32_t sumT, sumT2;
+    uint8_t  k;
+
+    result(sumT, sumT2, k, false);
+    return convert(sumT, sumT2);
+}
+
+/**
+ *  \brief              Return the last averaged period, 0 before the first reading.
+ */
+uint32_t MLX90614Pwm::period(void) {
+    uint32_t sumT, sumT2;
+    uint8_t  k;
+
+    result(sumT, sumT2, k, false);
+    return (sumT + k / 2) / k;
+}
+
+/**
+ *  \brief              Return the last reading in hundredths of a degree, integer arithmetic only.
+ *  \param [in] tunit   Temperature units, default &deg;C.
+ *  \return             Temperature in centi-degrees.
+ */
+int32_t MLX90614Pwm::readTempFixed(MLX90614::tempUnit_t tunit) {
+
+    uint32_t sumT, sumT2;
+    uint8_t  k;
+
+    result(sumT, sumT2, k, true);
+    int32_t cK = convert(sumT, sumT2);
+    switch(tunit) {
+        case MLX90614::MLX90614_TC : return MLX90614::centiKtoC(cK);
+        case MLX90614::MLX90614_TF : return MLX90614::centiCtoF(MLX90614::centiKtoC(cK));
+        default : return cK;
+    }
+}
+
+/**
+ *  \brief              Return the last reading.
+ *  \param [in] tunit   Temperature units, default &deg;C.
+ *  \return             Temperature.
+ */
+double MLX90614Pwm::readTemp(MLX90614::tempUnit_t tunit) {
+
+    uint32_t sumT, sumT2;
+    uint8_t  k;
+
+    result(sumT, sumT2, k, true);
+    return MLX90614::convKto(convert(sumT, sumT2) * 0.01, tunit);
+}
@@ -0,0 +1,123 @@
+#ifndef _MLX90614PWM_H_
+#define _MLX90614PWM_H_
+
+/***********************************************************************************************//**
+ *  \brief      Melexis MLX90614 Family Device Driver Library - PWM output decoder.
+ *  \par
+ *  \par        Details
+ *              Reads the object temperature from the PWM output pin instead of the SMBus, eg.
+ *              for sensors on long cables. The SMBus stays free for other devices.
+ *  \li         The device must be configured for single PWM mode (EEPROM register
+ *              MLX90614_PWMCTRL).
+ *  \li         Each period T starts with T/8 high, followed by t2 high, the data band (0...T/2).
+ *              The temperature is To = 2(t2/T)(To_max - To_min) + To_min, where To_max and To_min
+ *              are the output range in EEPROM (MLX90614_TOMAX, MLX90614_TOMIN).
+ *  \li         The decoder only sees edge timestamps. Feed it from a pin change interrupt or an
+ *              input capture unit, eg.
+ *  \code
+ *  MLX90614Pwm pwm(8);
+ *  void pwmEdge() {pwm.edge(micros(), digitalRead(PWM_PIN));}
+ *  attachInterrupt(digitalPinToInterrupt(PWM_PIN), pwmEdge, CHANGE);
+ *  \endcode
+ *              or from a recorded or synthetic edge stream on a host computer.
+ *  \li         Averaging over K periods is done on the summed times, so the timer resolution is
+ *              dithered out rather than rounded K times.
+ *  \li         Pulses shorter than T/16 are ignored as glitches. Periods that differ by more than
+ *              25% from the last accepted one, or whose high time lies outside the data band, are
+ *              rejected (missed edges).
+ *  \li         edge() only adds, compares and shifts, it is cheap enough for an interrupt. The
+ *              sums of a reading are kept as they are and converted by the read functions.
+ *  \li         The read functions and counters copy what edge() writes with interrupts disabled
+ *              (noInterrupts()), so edge() may be called from an interrupt. They re-enable
+ *              interrupts on return.
+ *
+ *  \file       MLX90614PWM.H
+ *  \author     J. F. Fitter <jfitter@eagleairaust.com.au>
+ *  \version    1.0
+ *  \date       2014-2017
+ *  \copyright  Copyright &copy; 2017 John Fitter.  All right reserved.
+ *
+ *  \par        License
+ *              This program is free software; you can redistribute it and/or modify it under
+ *              the terms of the GNU Lesser General Public License as published by the Free
+ *              Software Foundation; either version 2.1 of the License, or (at your option)
+ *              any later version.
+ *  \par
+ *              This Program is distributed in the hope that it will be useful, but WITHOUT ANY
+ *              WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *              PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details
+ *              at http://www.gnu.org/copyleft/gpl.html
+ *  \par
+ *              You should have received a copy of the GNU Lesser General Public License along
+ *              with this library; if not, write to the Free Software Foundation, Inc.,
+ *              51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *//***********************************************************************************************/
+
+#include "MLX90614.h"
+
+/**************************************************************************************************/
+/* Definitions                                                                                    */
+/**************************************************************************************************/
+
+#define MLX90614_TOMAXDEF       0x9993  /**< Factory To_max, 120.00 degC (centi-Kelvin) */
+#define MLX90614_TOMINDEF       0x62E3  /**< Factory To_min, -20.00 degC (centi-Kelvin) */
+#define MLX90614_PWMTOL         4       /**< Data band tolerance, 1/64ths of the period */
+#define MLX90614_PWMRELOCK      4       /**< Consecutive rejected periods before the period
+                                             reference is discarded */
+
+/**************************************************************************************************/
+/* MLX90614 PWM output decoder class.                                                             */
+/**************************************************************************************************/
+
+class MLX90614Pwm {
+public:
+    MLX90614Pwm(uint8_t periods = 1);
+
+    void     setRange(uint16_t toMin, uint16_t toMax);      /**< Output range (centi-Kelvin) */
+    uint8_t  readRange(MLX90614& dev);                      /**< Output range from the device */
+    void     setAverage(uint8_t periods);                   /**< Periods per reading (K) */
+    void     reset(void);                                   /**< Discard edges and partial sums */
+
+    boolean  edge(uint32_t t, boolean level);               /**< Edge at t (us), new pin level */
+    boolean  available(void)    {return _ready;}            /**< New reading since the last read */
+
+    int32_t  readTempFixed(MLX90614::tempUnit_t = MLX90614::MLX90614_TC);
+    double   readTemp(MLX90614::tempUnit_t = MLX90614::MLX90614_TC);
+    int32_t  centiK(void);                                  /**< Last reading (centi-Kelvin) */
+    uint32_t period(void);                                  /**< Last averaged period (us) */
+    uint32_t readings(void)     {return load(_readings);}   /**< Readings completed */
+    uint32_t rejected(void)     {return load(_rejected);}   /**< Periods rejected */
+    uint32_t glitches(void)     {return load(_glitches);}   /**< Short pulses ignored */
+
+private:
+    uint16_t _toMin;
+    uint16_t _toMax;
+    uint8_t  _k;
+    uint8_t  _n;                                            /**< Periods summed so far */
+    uint8_t  _bad;                                          /**< Consecutive rejected periods */
+    boolean  _level;                                        /**< Last pin level seen */
+    boolean  _haveRise;
+    boolean  _haveFall;
+    boolean  _haveNext;                                     /**< Next period has started */
+    volatile boolean _ready;
+    uint32_t _rise;                                         /**< Start of the current period */
+    uint32_t _fall;                                         /**< End of the current high time */
+    uint32_t _next;                                         /**< Start of the next period */
+    uint32_t _lastT;                                        /**< Last accepted period (us) */
+    uint32_t _sumT;                                         /**< Sum of periods (us) */
+    uint32_t _sumT2;                                        /**< Sum of data band high times (us) */
+    volatile uint8_t  _resK;                                /**< Periods in the last reading */
+    volatile uint32_t _resT;                                /**< Last reading, sum of periods */
+    volatile uint32_t _resT2;                               /**< Last reading, sum of high times */
+    volatile uint32_t _readings;
+    volatile uint32_t _rejected;
+    volatile uint32_t _glitches;
+
+    boolean  accept(uint32_t T, uint32_t thigh);
+    void     result(uint32_t& sumT, uint32_t& sumT2, uint8_t& k, boolean consume);
+    int32_t  convert(uint32_t sumT, uint32_t sumT2);
+    static uint32_t load(volatile uint32_t& v);
+};
+
+#endif /* _MLX90614PWM_H_ */
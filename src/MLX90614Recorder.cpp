@@ -0,0 +1,152 @@
+/***********************************************************************************************//**
+ *  \brief      Melexis MLX90614 Family Device Driver Library - Bus transaction recorder CPP Source file.
+ *  \file       MLX90614RECORDER.CPP
+ *  \author     J. F. Fitter <jfitter@eagleairaust.com.au>
+ *  \version    1.0
+ *  \date       2014-2017
+ *  \copyright  Copyright &copy; 2017 John Fitter.  All right reserved.
+ *
+ *  \par        License
+ *              This program is free software; you can redistribute it and/or modify it under
+ *              the terms of the GNU Lesser General Public License as published by the Free
+ *              Software Foundation; either version 2.1 of the License, or (at your option)
+ *              any later version.
+ *  \par
+ *              This Program is distributed in the hope that it will be useful, but WITHOUT ANY
+ *              WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *              PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details
+ *              at http://www.gnu.org/copyleft/gpl.html
+ *  \par
+ *              You should have received a copy of the GNU Lesser General Public License along
+ *              with this library; if not, write to the Free Software Foundation, Inc.,
+ *              51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *//***********************************************************************************************/
+
+#include "MLX90614Recorder.h"
+
+/**************************************************************************************************/
+/*  MLX90614 Bus record functions.                                                                */
+/**************************************************************************************************/
+
+void MLX90614BusRecord::pack(uint8_t* buf) const {
+
+    for(uint8_t i = 0; i < 4; i++) buf[i] = timestamp >> (8 * i);
+    buf[4] = kind;
+    buf[5] = status;
+    buf[6] = addr;
+    buf[7] = cmd;
+    buf[8] = lo;
+    buf[9] = hi;
+    buf[10] = pec;
+}
+
+void MLX90614BusRecord::unpack(const uint8_t* buf) {
+
+    timestamp = 0;
+    for(uint8_t i = 0; i < 4; i++) timestamp |= (uint32_t)buf[i] << (8 * i);
+    kind = buf[4];
+    status = buf[5];
+    addr = buf[6];
+    cmd = buf[7];
+    lo = buf[8];
+    hi = buf[9];
+    pec = buf[10];
+}
+
+/**************************************************************************************************/
+/*  MLX90614 Recording bus transport functions.                                                   */
+/**************************************************************************************************/
+
+/**
+ *  \brief             Recording transport constructor.
+ *  \param [in] bus    Transport that carries the transactions.
+ *  \param [in] sink   Destination of the records.
+ */
+MLX90614Recorder::MLX90614Recorder(MLX90614Bus& bus, MLX90614RecordSink& sink) {
+
+    _bus = &bus;
+    _sink = &sink;
+    records = 0;
+    _rec.kind = 0;
+}
+
+/**
+ *  \brief             Command phase of a read word, the record is written by receive().
+ */
+uint8_t MLX90614Recorder::sendCommand(uint8_t addr, uint8_t cmd) {
+
+    _rec.timestamp = micros();
+    _rec.kind = MLX90614_RECREAD;
+    _rec.addr = addr;
+    _rec.cmd = cmd;
+    return _rec.status = _bus->sendCommand(addr, cmd);
+}
+
+/**
+ *  \brief             Data phase of a read word. Writes the record of the whole transaction.
+ */
+uint8_t MLX90614Recorder::receive(uint8_t addr, uint8_t* buf, uint8_t len) {
+    uint8_t err = _bus->receive(addr, buf, len);
+
+    if(_rec.kind != MLX90614_RECREAD) {
+        // No command phase, record as a read of command 0xff.
+        _rec.timestamp = micros();
+        _rec.kind = MLX90614_RECREAD;
+        _rec.cmd = 0xff;
+        _rec.status = 0;
+    }
+    _rec.addr = addr;
+    _rec.status |= err;
+    _rec.lo = len > 0 ? buf[0] : 0xff;
+    _rec.hi = len > 1 ? buf[1] : 0xff;
+    _rec.pec = len > 2 ? buf[2] : 0xff;
+    emit();
+    return err;
+}
+
+/**
+ *  \brief             Write word (4 bytes) or send byte (2 bytes) transaction.
+ */
+uint8_t MLX90614Recorder::transmit(uint8_t addr, const uint8_t* buf, uint8_t len) {
+
+    _rec.timestamp = micros();
+    uint8_t err = _bus->transmit(addr, buf, len);
+    _rec.kind = (len == 2) ? MLX90614_RECSEND : MLX90614_RECWRITE;
+    _rec.status = err;
+    _rec.addr = addr;
+    _rec.cmd = len > 0 ? buf[0] : 0xff;
+    _rec.lo = len > 1 ? buf[1] : 0xff;
+    _rec.hi = len > 2 ? buf[2] : 0xff;
+    _rec.pec = len > 3 ? buf[3] : 0xff;
+    emit();
+    return err;
+}
+
+/**
+ *  \brief             Wake up line, passed through and recorded.
+ */
+boolean MLX90614Recorder::wakeLine(boolean low) {
+
+    _rec.timestamp = micros();
+    boolean ok = _bus->wakeLine(low);
+    _rec.kind = MLX90614_RECWAKE;
+    _rec.status = ok ? MLX90614_NORWERROR : MLX90614_TXOTHER;
+    _rec.addr = 0;
+    _rec.cmd = low ? 1 : 0;
+    _rec.lo = _rec.hi = _rec.pec = 0xff;
+    emit();
+    return ok;
+}
+
+/**
+ *  \brief             Encode the current record and pass it to the sink.
+ */
+void MLX90614Recorder::emit(void) {
+    uint8_t buf[MLX90614_BUSRECLEN];
+
+    _rec.pack(buf);
+    _sink->write(buf);
+    _rec.kind = 0;
+    ++records;
+}
@@ -0,0 +1,107 @@
+#ifndef _MLX90614RECORDER_H_
+#define _MLX90614RECORDER_H_
+
+/***********************************************************************************************//**
+ *  \brief      Melexis MLX90614 Family Device Driver Library - Bus transaction recorder.
+ *  \par
+ *  \par        Details
+ *              MLX90614Recorder is a bus transport that passes every transaction through to
+ *              another transport and writes a fixed size record of it to a sink (eg. a file on an
+ *              SD card, a serial port). A recorded session can be replayed on a host computer with
+ *              MLX90614ReplayBus (extras/host) to reproduce it exactly.
+ *  \li         Record (MLX90614_BUSRECLEN bytes, little endian): timestamp (us, 4 bytes),
+ *              kind, status, address, command, data low, data high, PEC.
+ *  \li         Kind is MLX90614_RECREAD (read word), MLX90614_RECWRITE (write word),
+ *              MLX90614_RECSEND (send byte - command and PEC in data low, eg. sleep) or
+ *              MLX90614_RECWAKE (wake line - command 1 drive SDA low, 0 release). Status is
+ *              the transport R/W error flags (all 8 bits, eg. MLX90614_RXCRC from a transport
+ *              that checks the PEC itself), a wake line the transport does not support is
+ *              recorded as MLX90614_TXOTHER.
+ *  \li         The timestamp is taken at the start of the transaction.
+ *
+ *  \file       MLX90614RECORDER.H
+ *  \author     J. F. Fitter <jfitter@eagleairaust.com.au>
+ *  \version    1.0
+ *  \date       2014-2017
+ *  \copyright  Copyright &copy; 2017 John Fitter.  All right reserved.
+ *
+ *  \par        License
+ *              This program is free software; you can redistribute it and/or modify it under
+ *              the terms of the GNU Lesser General Public License as published by the Free
+ *              Software Foundation; either version 2.1 of the License, or (at your option)
+ *              any later version.
+ *  \par
+ *              This Program is distributed in the hope that it will be useful, but WITHOUT ANY
+ *              WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *              PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details
+ *              at http://www.gnu.org/copyleft/gpl.html
+ *  \par
+ *              You should have received a copy of the GNU Lesser General Public License along
+ *              with this library; if not, write to the Free Software Foundation, Inc.,
+ *              51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *//***********************************************************************************************/
+
+#include "MLX90614.h"
+
+#define MLX90614_BUSRECLEN      11      /**< Bus record length (bytes) */
+#define MLX90614_RECREAD        0x10    /**< Bus record kind - read word */
+#define MLX90614_RECWRITE       0x20    /**< Bus record kind - write word */
+#define MLX90614_RECSEND        0x30    /**< Bus record kind - send byte (command, PEC) */
+#define MLX90614_RECWAKE        0x40    /**< Bus record kind - wake line event */
+#define MLX90614_RECKIND        0xF0    /**< Bus record kind - bitmask (packed with the status
+                                             in the 10 byte records of log versions 1 and 2) */
+#define MLX90614_RECSTATUS      0x0F    /**< Bus record status - bitmask (same) */
+
+/** Bus transaction record. */
+struct MLX90614BusRecord {
+    uint32_t timestamp;                                     /**< Transaction start (us) */
+    uint8_t  kind;                                          /**< MLX90614_REC* kind */
+    uint8_t  status;                                        /**< Transport R/W error flags */
+    uint8_t  addr;                                          /**< Slave address */
+    uint8_t  cmd;                                           /**< Command */
+    uint8_t  lo;                                            /**< Data low byte */
+    uint8_t  hi;                                            /**< Data high byte */
+    uint8_t  pec;                                           /**< PEC */
+
+    void     pack(uint8_t* buf) const;                      /**< Encode MLX90614_BUSRECLEN bytes */
+    void     unpack(const uint8_t* buf);                    /**< Decode MLX90614_BUSRECLEN bytes */
+};
+
+/**************************************************************************************************/
+/* MLX90614 Bus record sink interface.                                                            */
+/**************************************************************************************************/
+
+class MLX90614RecordSink {
+public:
+    virtual ~MLX90614RecordSink() {}
+
+    /** Store one encoded record of MLX90614_BUSRECLEN bytes. */
+    virtual void write(const uint8_t* rec) = 0;
+};
+
+/**************************************************************************************************/
+/* MLX90614 Recording bus transport class.                                                        */
+/**************************************************************************************************/
+
+class MLX90614Recorder : public MLX90614Bus {
+public:
+    MLX90614Recorder(MLX90614Bus& bus, MLX90614RecordSink& sink);
+
+    uint8_t  sendCommand(uint8_t addr, uint8_t cmd);
+    uint8_t  receive(uint8_t addr, uint8_t* buf, uint8_t len);
+    uint8_t  transmit(uint8_t addr, const uint8_t* buf, uint8_t len);
+    uint16_t turnaround(void) {return _bus->turnaround();}
+    boolean  wakeLine(boolean low);
+
+    uint32_t records;                                       /**< Records written */
+
+private:
+    MLX90614Bus* _bus;
+    MLX90614RecordSink* _sink;
+    MLX90614BusRecord _rec;                                 /**< Read in progress */
+
+    void     emit(void);
+};
+
+#endif /* _MLX90614RECORDER_H_ */
@@ -0,0 +1,106 @@
+#ifndef _MLX90614STATIC_H_
+#define _MLX90614STATIC_H_
+
+/***********************************************************************************************//**
+ *  \brief      Melexis MLX90614 Family Device Driver Library - Compile time specialized reader.
+ *  \par
+ *  \par        Details
+ *              A minimal front end for the common case of one fixed address, temperature source
+ *              and unit. Everything that the MLX90614 class works out at run time is a constant
+ *              here.
+ *  \li         The command byte and the CRC of the read header (addr<<1, cmd, (addr<<1)+1) are
+ *              computed by the compiler, the PEC check only runs over the 2 data bytes.
+ *  \li         The unit conversion is selected at compile time, both temperature paths reuse the
+ *              MLX90614 constexpr conversions.
+ *  \li         The transport and the read transaction (MLX90614::readWord()) are shared with the
+ *              MLX90614 class.
+ *  \li         The object holds only the bus pointer and the R/W error flags.
+ *  \li         Temperature reads only - use the MLX90614 class for configuration, EEPROM access,
+ *              retries and statistics.
+ *
+ *  \file       MLX90614STATIC.H
+ *  \author     J. F. Fitter <jfitter@eagleairaust.com.au>
+ *  \version    1.0
+ *  \date       2014-2017
+ *  \copyright  Copyright &copy; 2017 John Fitter.  All right reserved.
+ *
+ *  \par        License
+ *              This program is free software; you can redistribute it and/or modify it under
+ *              the terms of the GNU Lesser General Public License as published by the Free
+ *              Software Foundation; either version 2.1 of the License, or (at your option)
+ *              any later version.
+ *  \par
+ *              This Program is distributed in the hope that it will be useful, but WITHOUT ANY
+ *              WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *              PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details
+ *              at http://www.gnu.org/copyleft/gpl.html
+ *  \par
+ *              You should have received a copy of the GNU Lesser General Public License along
+ *              with this library; if not, write to the Free Software Foundation, Inc.,
+ *              51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *//***********************************************************************************************/
+
+#include "MLX90614.h"
+
+/**************************************************************************************************/
+/* MLX90614 Compile time specialized reader class.                                                */
+/**************************************************************************************************/
+
+template<uint8_t Addr = MLX90614_I2CDEFAULTADDR,
+         MLX90614::tempSrc_t Src = MLX90614::MLX90614_SRC01,
+         MLX90614::tempUnit_t Unit = MLX90614::MLX90614_TC>
+class MLX90614Static {
+    static_assert(Addr < 0x80, "SMBus address is 7 bits");
+public:
+    /** Command byte (RAM register) for the source. */
+    static constexpr uint8_t cmd = Src == MLX90614::MLX90614_SRCA  ? MLX90614_TA :
+                                   Src == MLX90614::MLX90614_SRC02 ? MLX90614_TOBJ2 : MLX90614_TOBJ1;
+
+    /** CRC-8 of the read header <tt>addr<<1, cmd, (addr<<1)+1</tt>. */
+    static constexpr uint8_t prefix =
+        CRC8::crc8Const(CRC8::crc8Const(CRC8::crc8Const(Addr << 1, MLX90614_CRC8POLY) ^ cmd,
+                                        MLX90614_CRC8POLY) ^ ((Addr << 1) + 1), MLX90614_CRC8POLY);
+
+    MLX90614Static(MLX90614Bus* bus = &MLX90614Wire) : rwError(MLX90614_NORWERROR), _bus(bus) {}
+
+    /**
+     *  \brief         Read the temperature register.
+     *  \return        Raw register value, resolution 0.02&deg;K. The R/W error flags are set.
+     */
+    uint16_t readRaw(void) {
+        uint8_t pec, crc;
+
+        rwError = MLX90614_NORWERROR;
+        return MLX90614::readWord(_bus, Addr, cmd, prefix, rwError, pec, crc);
+    }
+
+    /** Temperature in the template unit. */
+    double   readTemp(void)         {return toTemp(readRaw());}
+
+    /** Temperature in hundredths of a degree in the template unit, integer arithmetic only. */
+    int32_t  readTempFixed(void)    {return toFixed(readRaw());}
+
+    /** Convert a raw register value to the template unit. */
+    static constexpr double toTemp(uint16_t raw) {return MLX90614::convKto(MLX90614::rawToK(raw), Unit);}
+
+    /** Convert a raw register value to hundredths of a degree in the template unit. */
+    static constexpr int32_t toFixed(uint16_t raw) {
+        return Unit == MLX90614::MLX90614_TK ? MLX90614::rawToCentiK(raw) :
+               Unit == MLX90614::MLX90614_TC ? MLX90614::centiKtoC(MLX90614::rawToCentiK(raw)) :
+               MLX90614::centiCtoF(MLX90614::centiKtoC(MLX90614::rawToCentiK(raw)));
+    }
+
+    uint8_t  rwError;                                       /**< R/W error flags of the last read */
+
+private:
+    MLX90614Bus* _bus;                                      /**< Bus transport */
+};
+
+template<uint8_t Addr, MLX90614::tempSrc_t Src, MLX90614::tempUnit_t Unit>
+constexpr uint8_t MLX90614Static<Addr, Src, Unit>::cmd;
+
+template<uint8_t Addr, MLX90614::tempSrc_t Src, MLX90614::tempUnit_t Unit>
+constexpr uint8_t MLX90614Static<Addr, Src, Unit>::prefix;
+
+#endif /* _MLX90614STATIC_H_ */
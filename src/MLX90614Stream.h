@@ -0,0 +1,221 @@
+#ifndef _MLX90614STREAM_H_
+#define _MLX90614STREAM_H_
+
+/***********************************************************************************************//**
+ *  \brief      Melexis MLX90614 Family Device Driver Library - Sample ring buffer and streaming.
+ *  \par
+ *  \par        Details
+ *              MLX90614Ring is a fixed capacity, allocation free, lock free single producer /
+ *              single consumer queue of timestamped sample records. MLX90614Stream fills one from
+ *              a device's asynchronous read so that the sampling cadence is set by a timer tick,
+ *              not by how often the application gets round to reading.
+ *  \li         tick() may be called from a timer interrupt. It only records the request time.
+ *  \li         service() runs the reads from the main loop and produces the records.
+ *  \li         The application drains records in batches with drain() or pop().
+ *  \li         Overruns (ring full, record lost) and drops (tick arrived while the previous
+ *              acquisition was still running) are counted.
+ *  \li         A channel whose read cannot be started (the device is busy with another
+ *              asynchronous read) still gets a record, flagged MLX90614_INVALIDATA.
+ *  \li         Capacity N must be a power of 2, at most 128.
+ *
+ *  \file       MLX90614STREAM.H
+ *  \author     J. F. Fitter <jfitter@eagleairaust.com.au>
+ *  \version    1.0
+ *  \date       2014-2017
+ *  \copyright  Copyright &copy; 2017 John Fitter.  All right reserved.
+ *
+ *  \par        License
+ *              This program is free software; you can redistribute it and/or modify it under
+ *              the terms of the GNU Lesser General Public License as published by the Free
+ *              Software Foundation; either version 2.1 of the License, or (at your option)
+ *              any later version.
+ *  \par
+ *              This Program is distributed in the hope that it will be useful, but WITHOUT ANY
+ *              WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS FOR A
+ *              PARTICULAR PURPOSE. See the GNU Lesser General Public License for more details
+ *              at http://www.gnu.org/copyleft/gpl.html
+ *  \par
+ *              You should have received a copy of the GNU Lesser General Public License along
+ *              with this library; if not, write to the Free Software Foundation, Inc.,
+ *              51 Franklin St, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ *//***********************************************************************************************/
+
+#include "MLX90614.h"
+
+/** Index access with acquire/release ordering. Single byte accesses are atomic on all targets. */
+#define MLX90614_LOAD(x)        __atomic_load_n(&(x), __ATOMIC_ACQUIRE)
+#define MLX90614_STORE(x, v)    __atomic_store_n(&(x), (v), __ATOMIC_RELEASE)
+
+/** Streamed sample record. */
+struct MLX90614Record {
+    uint32_t timestamp;                                     /**< Sample request time (us) */
+    uint8_t  channel;                                       /**< RAM register read */
+    uint8_t  flags;                                         /**< R/W error flags */
+    uint16_t raw;                                           /**< Raw register value */
+};
+
+/**************************************************************************************************/
+/* MLX90614 Sample ring buffer class.                                                             */
+/**************************************************************************************************/
+
+template<uint8_t N> class MLX90614Ring {
+    static_assert(N && (N <= 128) && !(N & (N - 1)), "Capacity must be a power of 2, at most 128");
+public:
+    MLX90614Ring() : overruns(0), _head(0), _tail(0) {}
+
+    /**
+     *  \brief            Add a record (producer side).
+     *  \param [in] rec   Record to add.
+     *  \return           False if the ring is full, the record is lost and counted as an overrun.
+     */
+    boolean push(const MLX90614Record& rec) {
+        uint8_t head = _head;
+
+        if((uint8_t)(head - MLX90614_LOAD(_tail)) >= N) {
+            ++overruns;
+            return false;
+        }
+        _buf[head & (N - 1)] = rec;
+        MLX90614_STORE(_head, (uint8_t)(head + 1));
+        return true;
+    }
+
+    /**
+     *  \brief            Remove the oldest record (consumer side).
+     *  \param [out] rec  Receives the record.
+     *  \return           False if the ring is empty.
+     */
+    boolean pop(MLX90614Record& rec) {
+        uint8_t tail = _tail;
+
+        if(tail == MLX90614_LOAD(_head)) return false;
+        rec = _buf[tail & (N - 1)];
+        MLX90614_STORE(_tail, (uint8_t)(tail + 1));
+        return true;
+    }
+
+    /**
+     *  \brief            Remove up to max records in one batch (consumer side).
+     *  \param [out] out  Receives the records, oldest first.
+     *  \param [in] max   Capacity of out.
+     *  \return           Number of records removed.
+     */
+    uint8_t drain(MLX90614Record* out, uint8_t max) {
+        uint8_t tail = _tail, n = MLX90614_LOAD(_head) - tail;
+
+        if(n > max) n = max;
+        for(uint8_t i = 0; i < n; i++) out[i] = _buf[(uint8_t)(tail + i) & (N - 1)];
+        MLX90614_STORE(_tail, (uint8_t)(tail + n));
+        return n;
+    }
+
+    uint8_t  available(void) {return MLX90614_LOAD(_head) - MLX90614_LOAD(_tail);}  /**< Records */
+    uint8_t  capacity(void)  {return N;}                                            /**< Size */
+
+    uint32_t overruns;                                      /**< Records lost, ring full */
+
+private:
+    MLX90614Record _buf[N];
+    uint8_t  _head;                                         /**< Written by the producer only */
+    uint8_t  _tail;                                         /**< Written by the consumer only */
+};
+
+/**************************************************************************************************/
+/* MLX90614 Streaming acquisition class.                                                          */
+/**************************************************************************************************/
+
+template<uint8_t N> class MLX90614Stream : public MLX90614Ring<N> {
+public:
+    /**
+     *  \brief             Streaming acquisition constructor.
+     *  \param [in] dev    Device to read.
+     *  \param [in] mask   Channels to read on each tick (MLX90614_CH* bitmask).
+     */
+    MLX90614Stream(MLX90614& dev, uint8_t mask = MLX90614_CHTOBJ1)
+        : _drops(0), _dev(&dev), _mask(mask & MLX90614_CHALL), _reqs(0), _served(0), _ch(0),
+          _busy(false), _out(0) {}
+
+    /**
+     *  \brief  Request an acquisition of all channels. Safe to call from an interrupt.
+     */
+    void tick(void) {
+        uint8_t reqs = _reqs;
+
+        if(reqs != MLX90614_LOAD(_served)) {
+            ++_drops;
+            return;
+        }
+        _tickTime = micros();
+        MLX90614_STORE(_reqs, (uint8_t)(reqs + 1));
+    }
+
+    /**
+     *  \brief  Run the acquisition. Call from the main loop as often as possible.
+     *  \return Number of records stored by this call (records lost to a full ring are only
+     *          counted in overruns).
+     */
+    uint8_t service(void) {
+
+        _out = 0;
+        if(!_busy) {
+            if(MLX90614_LOAD(_reqs) == _served) return 0;
+            _stamp = _tickTime;
+            _busy = true;
+            _ch = 0;
+            if(!next()) return _out;
+        }
+        if(_dev->poll() == MLX90614::MLX90614_PENDING) return 0;
+
+        emit(_dev->rwError, _dev->rawResult());
+        ++_ch;
+        next();
+        return _out;
+    }
+
+    /** Ticks lost, acquisition busy. Copied with interrupts disabled, tick() may be an ISR. */
+    uint32_t drops(void) {
+        noInterrupts();
+        uint32_t n = _drops;
+        interrupts();
+        return n;
+    }
+
+private:
+    volatile uint32_t _drops;                               /**< Ticks lost (interrupt side) */
+    MLX90614* _dev;
+    uint8_t  _mask;
+    uint8_t  _reqs;                                         /**< Ticks accepted (interrupt side) */
+    uint8_t  _served;                                       /**< Ticks completed (loop side) */
+    uint8_t  _ch;                                           /**< Channel being read */
+    boolean  _busy;
+    uint8_t  _out;                                          /**< Records stored by service() */
+    volatile uint32_t _tickTime;
+    uint32_t _stamp;
+
+    /** Record the current channel. */
+    void emit(uint8_t flags, uint16_t raw) {
+        MLX90614Record rec;
+
+        rec.timestamp = _stamp;
+        rec.channel = MLX90614_RAWIR1 + _ch;
+        rec.flags = flags;
+        rec.raw = raw;
+        if(this->push(rec)) ++_out;
+    }
+
+    /** Start the next channel of the acquisition, or finish it. */
+    boolean next(void) {
+
+        for(; _ch < 5; ++_ch) {
+            if(!((_mask >> _ch) & 1)) continue;
+            if(_dev->startReadRaw(MLX90614_RAWIR1 + _ch)) return true;
+            emit(MLX90614_INVALIDATA, 0);
+        }
+        _busy = false;
+        MLX90614_STORE(_served, (uint8_t)(_served + 1));
+        return false;
+    }
+};
+
+#endif /* _MLX90614STREAM_H_ */
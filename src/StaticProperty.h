@@ -0,0 +1,36 @@
+#ifndef _StaticProperty_H_
+#define _StaticProperty_H_
+
+// Compile time version of Property<> - the accessors are template arguments, so the property has no
+// storage of its own and every access is a direct (inlinable) call.
+//
+// The property must be placed at offset 0 of its owner, it finds the owner by casting its own
+// address. Several properties of one class share that byte by declaring them in an anonymous union
+// as the first member. The getter (and setter) must be declared before the property. The owner
+// should static_assert that the properties are at offset 0 (see MLX90614.h), a base class or a
+// virtual function would move them.
+
+template<typename Type, typename ClassHolder, Type (ClassHolder::*Get)(),
+         void (ClassHolder::*Set)(Type Val) = nullptr>
+
+class StaticProperty {
+private:
+    ClassHolder * Class() {
+        return reinterpret_cast<ClassHolder *>(this);
+    }
+
+public:
+    // set
+    Type operator = (const Type& In) {
+        static_assert(Set != nullptr, "Property is read only");
+        (Class()->*Set)(In);
+        return In;
+    }
+
+    // get
+    operator Type() {
+        return (Class()->*Get)();
+    }
+};
+
+#endif /* _StaticProperty_H_ */